@@ -5,8 +5,32 @@
 #include "lib/random.h"
 #include "dev/button-sensor.h"
 #include "dev/leds.h"
+#include "sys/node-id.h"
+#include "attack.h"
+#include "trust-auth.h"
+#include "link-sec.h"
+#include "dup-cache.h"
+#include "sink-stats.h"
+#include "rate-limit.h"
+#include "link-filter.h"
+#include "mac-blacklist.h"
+#include "fwd-queue.h"
+#include "data-header.h"
+#include "aggregate.h"
+#include "reliable-hop.h"
+#include "link-quality.h"
+#include "trust-store.h"
+#include "journal.h"
+#include "profile.h"
+#include "stack-mark.h"
+#include "cluster.h"
+#include "blocklist.h"
+#include "trust-sync.h"
+#include "dev/serial-line.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 /*------------------------- DECLARATIONS -------------------------*/
 
@@ -14,11 +38,67 @@
 
 #define CHANNEL 135
 #define NEIGHBOR_TIMEOUT 10 * CLOCK_SECOND
+// raised by the host benchmark to time the table kernels at larger sizes
+#ifndef MAX_NEIGHBORS
 #define MAX_NEIGHBORS 16
+#endif
+// beacon channel and intervals of neighbor discovery; the interval starts
+// at DISCOVERY_INITIAL_INTERVAL whenever the neighbor table changes and
+// doubles up to DISCOVERY_MAX_INTERVAL, which stays below NEIGHBOR_TIMEOUT
+#define DISCOVERY_CHANNEL 130
+#define DISCOVERY_INITIAL_INTERVAL (CLOCK_SECOND / 2)
+#define DISCOVERY_MIN_INTERVAL (CLOCK_SECOND / 2)
+#define DISCOVERY_MAX_INTERVAL (8 * CLOCK_SECOND)
+// defaults of the parameters that can be changed over the serial line
 #define MAT 50
 // minimum delay in seconds
 #define MINIMUM_DELAY 5
+// period of the trust vector broadcasts in seconds
+#define BROADCAST_PERIOD 1
 #define DEFAULT_DELAY 6
+// trust from which a next hop gets RELIABLE_MAX_RETX retransmissions in
+// reliable mode; less trusted hops are only used, best effort, when no
+// trusted one is left
+#define RELIABLE_TRUST 80
+#define RELIABLE_MAX_RETX 3
+// trust lost by a neighbor for each message the sink sheds from it
+#define SHED_PENALTY 2
+// send delay in seconds of the flooding role
+#define FLOODING_DELAY 1
+// node that runs MALICIOUS_ROLE; building with ROLE=... instead runs that
+// role on every node
+#ifndef MALICIOUS_NODE_ID
+#define MALICIOUS_NODE_ID 15
+#endif
+#ifndef MALICIOUS_ROLE
+#define MALICIOUS_ROLE ROLE_FLOODING
+#endif
+// trust change after which a neighbor's trust is journaled again
+#define JOURNAL_TRUST_STEP 10
+// period of the trust table snapshots to flash
+#define STORE_INTERVAL (30 * CLOCK_SECOND)
+// seconds without a fresh frame after which a neighbor whose frame counter
+// went backwards is taken to have rebooted without it
+#define REPLAY_TIMEOUT 30
+#if TRUST_SYNC_ENABLED && CLUSTER_ENABLED
+#error "enable only one of TRUST_SYNC_ENABLED and CLUSTER_ENABLED"
+#endif
+
+/* ROLES */
+// behaviour profiles a node can run
+enum node_role
+{
+  ROLE_HONEST,
+  ROLE_FLOODING,
+  ROLE_BLACKHOLE,
+  ROLE_GRAYHOLE,
+  ROLE_SELECTIVE_FORWARDING,
+  ROLE_ON_OFF,
+  ROLE_BAD_MOUTHING,
+  ROLE_BALLOT_STUFFING,
+  ROLE_SYBIL,
+  ROLE_COUNT
+};
 
 /* STRUCTS */
 // a node in the neighbor list
@@ -29,6 +109,39 @@ struct neighbor {
   struct ctimer ctimer;
   // value in seconds
   long unsigned int last_received;
+  // value in seconds, used to measure how long isolation took
+  long unsigned int first_seen;
+  // set while trust is below MAT
+  uint8_t isolated;
+  // trust last written to the journal
+  uint8_t journaled_trust;
+  // last frame counters of the neighbor's trust broadcasts and of its
+  // multihop frames (anti-replay keeps broadcast and unicast apart)
+  struct anti_replay_info replay;
+  // value in seconds, when the last frame passed anti-replay
+  long unsigned int last_fresh;
+  // key authenticating multihop data on the link, revoked on isolation
+  struct link_key link_key;
+  // RSSI, LQI and ETX of the link, weighs next-hop selection with trust
+  struct link_quality link;
+#if CLUSTER_ENABLED
+  // set while the neighbor announces itself as cluster head
+  uint8_t head;
+  // trust the cluster head last advertised for the neighbor
+  uint8_t head_trust;
+#endif
+#if TRUST_SYNC_ENABLED
+  // table clock when the trust advertised for the neighbor last changed
+  uint16_t version;
+  // trust advertised since that version
+  uint8_t synced_trust;
+  // clock of the neighbor's table up to which its entries were merged
+  uint16_t synced_clock;
+  // clock of the neighbor's table in its last digest
+  uint16_t digest_clock;
+  // set while a request for the neighbor's entries is queued
+  uint8_t sync_request;
+#endif
 };
 // the struct sent over broadcast
 struct neighbor_trust
@@ -36,33 +149,207 @@ struct neighbor_trust
   linkaddr_t addr;
   int trust;
 };
+// records that fit in one sealed trust broadcast behind hdr bytes of
+// header; larger tables are advertised a window at a time
+#define TRUST_RECORDS_MAX(hdr) ((TRUST_AUTH_MAX_DATA - (hdr)) \
+  / sizeof(struct neighbor_trust))
+// records of a trust vector
+#define TRUST_VECTOR_MAX TRUST_RECORDS_MAX(0)
+// records of a sync response
+#define SYNC_ENTRIES_MAX TRUST_RECORDS_MAX(sizeof(struct trust_sync_header))
+
+// cursor over the trust records of a received broadcast
+// reads them in place from packetbuf instead of copying the whole packet
+struct trust_reader
+{
+  const uint8_t *pos;
+  const uint8_t *end;
+};
+
+// trust parameters, tunable at runtime over the serial line
+struct trust_params
+{
+  // trust below which a neighbor is isolated
+  uint8_t mat;
+  // messages closer together than this many seconds lower trust
+  uint8_t minimum_delay;
+  // seconds between trust vector broadcasts
+  uint8_t broadcast_period;
+};
+
+// parameters of a behaviour profile
+struct node_profile
+{
+  const char *name;
+  // delay between multihop messages in seconds
+  uint8_t send_delay;
+  // attacker behaviour, ATTACK_NONE for honest nodes
+  enum attack_type attack;
+};
 
 /* UTILITY FUNCTIONS */
+// picks the role from ROLE if defined, otherwise from the node id
+// (the Sky has no EEPROM, so lib/settings is not available)
+static enum node_role select_role(void);
 // check if an address is trusted
 static int addr_is_blocked(const linkaddr_t* a);
-static void update_table(void* _nt);
-// called when a neighbor's ctimer runs out and reduecs its trust value
+// returns the neighbor table entry of an address, or NULL
+static struct neighbor* find_neighbor(const linkaddr_t* a);
+// copies the data header out of packetbuf, returns 0 if the packet is too short
+static int read_header(struct data_header* h);
+// copies the data header back into packetbuf
+static void write_header(const struct data_header* h);
+// lowers trust by amount, keeping it above 0 (which ends a trust vector)
+static void lower_trust(struct neighbor* n, int amount);
+// logs when a neighbor crosses MAT, with the time it took since first contact
+// also journals the neighbor's trust when it moved by JOURNAL_TRUST_STEP
+static void check_isolation(struct neighbor* n);
+// runs one serial line command
+static void run_command(char* line);
+// prints the trust parameters
+static void print_params(void);
+// beacon value announcing the table size, and the head role in cluster mode
+static uint16_t beacon_val(void);
+#if CLUSTER_ENABLED
+// re-elects the head among the trusted neighbors and announces a changed
+// role right away
+static void elect_head(void);
+// returns 1 if n goes into the next trust vector, heads list suspects
+// while members report where they disagree with their head
+static int cluster_advertised(struct neighbor* n, int trust);
+#endif
+#if BLOCKLIST_ENABLED
+// floods the addresses of the isolated neighbors as the node's blocklist
+static void publish_blocklist(void);
+// called when an address gets blocked or released network-wide
+static void blocklist_changed(const linkaddr_t* a, uint8_t blocked);
+// returns 1 if a is a neighbor whose blocklist counts: known, not
+// isolated and trusted at or above MAT
+static int blocklist_trusted(const linkaddr_t* a);
+#endif
+#if TRUST_SYNC_ENABLED
+// gives every entry whose advertised trust changed the next table version
+static void sync_versions(void);
+// writes a sync header into an empty packetbuf, target NULL if unused
+static void write_sync_header(uint8_t type, const linkaddr_t* target,
+  uint16_t since, uint16_t clock);
+// writes the entries that changed after since into packetbuf, the oldest
+// changes first if they do not all fit
+static void write_entries(uint16_t since);
+// handles a digest, request or response received from e
+static void sync_input(struct neighbor* e);
+// sends the queued response or one queued request, then reschedules
+static void sync_send(void* ptr);
+// queues sync_send unless it is already waiting
+static void sync_schedule(void);
+#endif
+// seals packetbuf and broadcasts it on the trust channel
+static void send_trust(void);
+#if !TRUST_SYNC_ENABLED
+// writes the next window of the neighbor table into packetbuf as a trust
+// vector, wrapping around to the head once the end of the table is reached
+static void write_vector(void);
+#endif
+// prints the neighbor table as one "T <hex>" line of 6-byte records:
+// address, trust, isolated flag and ETX (little endian)
+static void dump_table(void);
+// merges the trust records of the current packetbuf into the neighbor table
+static void update_table(void);
+// points the reader at the records in packetbuf
+static void trust_reader_init(struct trust_reader *r);
+// reads the next record, returns 0 at the end of the data or on a zero trust
+static int trust_reader_next(struct trust_reader *r, struct neighbor_trust *nt);
+// called when a neighbor's ctimer runs out, frees the entry of a silent
+// neighbor unless it is the sink or isolated, which keeps its verdict
 static void remove_neighbor(void* _n);
+// adds a newly heard node to the neighbor table, returns NULL if it is full
+static struct neighbor* add_neighbor(const linkaddr_t* a);
+#if TRUST_STORE_ENABLED
+// refills the neighbor table from the last flash snapshot, re-isolating
+// the neighbors that were isolated before the reboot
+static void restore_table(void);
+// writes the neighbor table to flash if it changed, then reschedules itself
+static void store_table(void* ptr);
+#endif
 /* MULTIHOP FUNCTIONS */
 // called when a multihop message is received (only at the target address)
 // decreases trust value if messages received too frequently
 static void recv(struct multihop_conn* c, const linkaddr_t* sender,
   const linkaddr_t* prevhop, uint8_t hops);
+// sends a packet released by the forwarding queue, collecting plain
+// messages of the same flush into one aggregate
+static void send_queued(const linkaddr_t* nexthop, uint8_t remaining);
+#if AGGREGATE_ENABLED
+// sends the collected aggregate to n
+static void send_aggregate(struct neighbor* n);
+#endif
+// adds the link MIC for n, returns 0 if n has no key
+static int seal_for(struct neighbor* n);
+// sends a sealed packet to n, over runicast in reliable mode
+static void send_sealed(struct neighbor* n);
+// picks a random neighbor other than skip, unless skip is the only one,
+// among those trusted at least min_trust; returns NULL if there is none
+// chances follow trust and link quality, so lossy links are rarely used
+static struct neighbor* choose_next_hop(const linkaddr_t* skip, int min_trust);
+// whether choose_next_hop may route through the neighbor
+static int next_hop_eligible(const struct neighbor* n, const linkaddr_t* skip, int min_trust);
+// feeds the frame in packetbuf into the link estimate of its sender
+static void heard(struct neighbor* n);
+// runs the anti-replay check on the frame verified from n, starting the
+// counters over if n was quiet for REPLAY_TIMEOUT; returns 1 to drop it
+static int replayed(struct neighbor* n,
+  int (*check)(struct anti_replay_info* info));
+#if RELIABLE_HOP_ENABLED
+// reliable mode: handles a packet received over runicast like multihop would
+static void reliable_input(const linkaddr_t* from);
+// reliable mode: counts the retransmissions into the link estimate
+static void reliable_sent(const linkaddr_t* nexthop, uint8_t retransmissions);
+// reliable mode: moves a packet the next hop did not acknowledge elsewhere
+static const linkaddr_t* reliable_reroute(const linkaddr_t* nexthop,
+  uint8_t* max_retx);
+// reliable mode: retransmissions a next hop is worth, 0 for hops that are
+// only sent to best effort
+static uint8_t retx_budget(const struct neighbor* n);
+#endif
+// sheds the message if the originator exceeds its rate at the sink, and
+// penalizes prevhop for it if prevhop is the originator
+static int admit(const linkaddr_t* origin, struct neighbor* prevhop);
+// hands one message that arrived from prevhop to the sink application,
+// unless the originator is blocked, the message a duplicate or over the
+// originator's rate
+static void deliver(const linkaddr_t* origin, struct neighbor* prevhop,
+  const struct data_header* hdr, const char* payload);
 // multihop forward
 // forwards to a random neighbor
 static linkaddr_t* forward(struct multihop_conn* c, const linkaddr_t* originator, 
   const linkaddr_t* dest, const linkaddr_t* prevhop, uint8_t hops);
+// forward() under PROFILE_FORWARD, called instead of it
+static linkaddr_t* timed_forward(struct multihop_conn* c,
+  const linkaddr_t* originator, const linkaddr_t* dest,
+  const linkaddr_t* prevhop, uint8_t hops);
 /* BROADCAST FUNCTIONS */
 // called when a broadcast message is received
 // adds the sender to neighbor list if not already present
 static void broadcast_recv(struct broadcast_conn *c, const linkaddr_t *from);
+// broadcast_recv() under PROFILE_BROADCAST_RECV, called instead of it
+static void timed_broadcast_recv(struct broadcast_conn *c,
+  const linkaddr_t *from);
+/* NEIGHBOR DISCOVERY FUNCTIONS */
+// called when a discovery beacon is received, val is the number of
+// neighbors the sender knows
+// beacons are not authenticated, so an unknown sender is not added; the
+// next trust vector goes out even with an empty table to introduce us
+static void discovery_recv(struct neighbor_discovery_conn *c,
+  const linkaddr_t *from, uint16_t val);
 
 /* PROCESS REGISTRATION */
 // sends multihop messages to 1.0 via neighbors
 PROCESS(multihop_process, "multihop process");
 // shares trust table with neighbors
 PROCESS(broadcast_process, "broadcast process");
-AUTOSTART_PROCESSES(&multihop_process, &broadcast_process);
+// runs commands received over the serial line
+PROCESS(serial_process, "serial process");
+AUTOSTART_PROCESSES(&multihop_process, &broadcast_process, &serial_process);
 
 /* GLOBAL VARIABLES */
 // neighbor list
@@ -72,51 +359,165 @@ MEMB(neighbor_mem, struct neighbor, MAX_NEIGHBORS);
 // the sink node's address
 static linkaddr_t sink_addr;
 // multi hop callbackfunctions
-static const struct multihop_callbacks multihop_call = {recv, forward};
+static const struct multihop_callbacks multihop_call = {recv, timed_forward};
 // multi hop connection
 static struct multihop_conn multihop;
 // broadcast callback functions
-static const struct broadcast_callbacks broadcast_call = {broadcast_recv};
+static const struct broadcast_callbacks broadcast_call = {
+  timed_broadcast_recv
+};
 // broadcast connection
 static struct broadcast_conn broadcast;
+// neighbor discovery callback functions
+static const struct neighbor_discovery_callbacks discovery_call = {
+  discovery_recv, NULL
+};
+// neighbor discovery connection
+static struct neighbor_discovery_conn discovery;
+#if TRUST_STORE_ENABLED
+// period of the trust table snapshots
+static struct ctimer store_timer;
+// snapshot being stored or restored, kept off the stack
+static struct trust_record store_records[TRUST_STORE_MAX_RECORDS];
+#endif
+#if !TRUST_SYNC_ENABLED
+// table position the next trust vector starts at
+static uint16_t vector_start;
+#endif
+// set by a beacon from an unknown node, which adds us once it verified
+// one of our trust broadcasts
+static uint8_t introduce;
+// trust vectors sent and their size on air, to compare exchange modes
+static uint16_t trust_frames;
+static uint32_t trust_bytes;
+#if TRUST_SYNC_ENABLED
+// bumped whenever an advertised trust changes, sent as the digest
+static uint16_t table_clock;
+// oldest clock asked for while a response is queued
+static uint16_t respond_since;
+static uint8_t respond_pending;
+// spaces out queued requests and responses
+static struct ctimer sync_timer;
+#endif
+// profiles indexed by role
+static const struct node_profile profiles[ROLE_COUNT] = {
+  {"honest", DEFAULT_DELAY, ATTACK_NONE},
+  {"flooding", FLOODING_DELAY, ATTACK_FLOODING},
+  {"blackhole", DEFAULT_DELAY, ATTACK_BLACKHOLE},
+  {"grayhole", DEFAULT_DELAY, ATTACK_GRAYHOLE},
+  {"selective forwarding", DEFAULT_DELAY, ATTACK_SELECTIVE_FORWARDING},
+  {"on-off", FLOODING_DELAY, ATTACK_ON_OFF},
+  {"bad-mouthing", DEFAULT_DELAY, ATTACK_BAD_MOUTHING},
+  {"ballot-stuffing", DEFAULT_DELAY, ATTACK_BALLOT_STUFFING},
+  {"sybil", DEFAULT_DELAY, ATTACK_SYBIL},
+};
+// profile this node runs
+static const struct node_profile *profile = &profiles[ROLE_HONEST];
+// sequence number of the last multihop message sent; sink-stats counts
+// gaps in it as losses, so only plain messages take numbers from it
+static uint16_t data_seqno;
+#if AGGREGATE_ENABLED
+// sequence number of the last aggregate sent
+static uint16_t aggregate_seqno;
+#endif
+// current trust parameters, MAT and friends until changed over serial
+static struct trust_params params = {MAT, MINIMUM_DELAY, BROADCAST_PERIOD};
+#if BLOCKLIST_ENABLED
+// blocklist callback functions
+static const struct blocklist_callbacks blocklist_call = {
+  blocklist_trusted, blocklist_changed
+};
+#endif
+#if RELIABLE_HOP_ENABLED
+// reliable hop callback functions
+static const struct reliable_hop_callbacks reliable_call = {
+  reliable_input, reliable_sent, reliable_reroute
+};
+#endif
 /*---------------------------------------------------------------------------*/
 /*------------------------- DEFINITIONS -------------------------*/
 
 /* PROCESS THREADS */
 
 // multihop process
-// sends data to 1.0 every 2 seconds
+// sends data to 1.0 every send_delay seconds of the profile
 PROCESS_THREAD(multihop_process, ev, data)
 {
   static struct etimer et;
+  struct data_header hdr;
 
-  PROCESS_EXITHANDLER(multihop_close(&multihop);)
+  PROCESS_EXITHANDLER(multihop_close(&multihop);
+    neighbor_discovery_close(&discovery);)
   
   PROCESS_BEGIN();
+#if STACK_MARK_ENABLED
+  stack_mark_init();
+#endif
 
   sink_addr.u8[0] = 1;
   sink_addr.u8[1] = 0;
 
+  profile = &profiles[select_role()];
+  printf("Running %s profile\n", profile->name);
+  attack_init(profile->attack);
+
   /* Initialize the memory for the neighbor table entries. */
   memb_init(&neighbor_mem);
 
   /* Initialize the list used for the neighbor table. */
   list_init(neighbor_table);
 
+#if JOURNAL_ENABLED
+  journal_init();
+#endif
+  // before any neighbor is added, the first ones are keyed with the master
+  link_sec_init();
+  // opened before the table is restored, since new neighbors restart it
+  neighbor_discovery_open(&discovery, DISCOVERY_CHANNEL,
+    DISCOVERY_INITIAL_INTERVAL, DISCOVERY_MIN_INTERVAL,
+    DISCOVERY_MAX_INTERVAL, &discovery_call);
+  neighbor_discovery_start(&discovery, beacon_val());
+#if BLOCKLIST_ENABLED
+  // before the restore, which republishes the isolated neighbors
+  blocklist_open(&blocklist_call, &sink_addr);
+#endif
+#if TRUST_STORE_ENABLED
+  restore_table();
+  // stored at once, so a counter ceiling is on flash before the first frame
+  store_table(NULL);
+#endif
+
   /* Open a multihop connection on Rime channel CHANNEL. */
   multihop_open(&multihop, CHANNEL, &multihop_call);
+  fwd_queue_init(send_queued);
+#if RELIABLE_HOP_ENABLED
+  reliable_hop_open(&reliable_call);
+#endif
+
+  if(linkaddr_cmp(&linkaddr_node_addr, &sink_addr))
+    sink_stats_init();
 
   while(1) {
-    etimer_set(&et, DEFAULT_DELAY * CLOCK_SECOND);
+    // an on-off attacker behaves honestly during its off phase
+    etimer_set(&et, (attack_phase_on() ? profile->send_delay : DEFAULT_DELAY)
+      * CLOCK_SECOND);
 
     PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
 
-    packetbuf_copyfrom("Hello", 6);
+    hdr.seqno = ++data_seqno;
+    hdr.timestamp = clock_time();
+    hdr.hops = 0;
+    hdr.type = DATA_PLAIN;
+    packetbuf_clear();
+    memcpy(packetbuf_dataptr(), &hdr, sizeof(hdr));
+    memcpy((uint8_t*)packetbuf_dataptr() + sizeof(hdr), "Hello", 6);
+    packetbuf_set_datalen(sizeof(hdr) + 6);
 
     if(!linkaddr_cmp(&linkaddr_node_addr, &sink_addr))
     {
       multihop_send(&multihop, &sink_addr);
       printf("Sending multihop message to 1.0\n");
+      fwd_queue_report();
     }
 
   }
@@ -127,25 +528,48 @@ PROCESS_THREAD(multihop_process, ev, data)
 // shares trust table with neighbors
 PROCESS_THREAD(broadcast_process, ev, data)
 {
-  struct neighbor_trust nt[MAX_NEIGHBORS] = {};
   static struct etimer et;
-  struct neighbor* n;
-  int i;
   PROCESS_EXITHANDLER(broadcast_close(&broadcast));
   PROCESS_BEGIN();
   broadcast_open(&broadcast, 129, &broadcast_call);
   while(1)
   {
-    etimer_set(&et, 1 * CLOCK_SECOND);
+    etimer_set(&et, params.broadcast_period * CLOCK_SECOND);
     PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
-    for(n = list_head(neighbor_table), i = 0; n != NULL; n = n->next, i++)
-    {
-      nt[i].addr = n->addr;
-      nt[i].trust = n->trust;
-    }
-    packetbuf_copyfrom(nt, sizeof(nt));
-    broadcast_send(&broadcast);
+#if CLUSTER_ENABLED
+    elect_head();
+#endif
+    // nobody to gossip with yet, the beacons will find them
+    if(list_head(neighbor_table) == NULL && !introduce)
+      continue;
+#if TRUST_SYNC_ENABLED
+    // neighbors that are behind pull the changes
+    sync_versions();
+    write_sync_header(TRUST_SYNC_DIGEST, NULL, 0, table_clock);
+#else
+    write_vector();
+#endif
+#if CLUSTER_ENABLED
+    // nothing the cluster does not know already
+    if(packetbuf_datalen() == 0 && !introduce)
+      continue;
+#endif
+    introduce = 0;
+    send_trust();
+
+  }
+  PROCESS_END();
+}
 
+// serial process
+// runs the commands of run_command()
+PROCESS_THREAD(serial_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1)
+  {
+    PROCESS_WAIT_EVENT_UNTIL(ev == serial_line_event_message);
+    run_command(data);
   }
   PROCESS_END();
 }
@@ -156,35 +580,281 @@ static void recv(struct multihop_conn* c, const linkaddr_t* sender,
   const linkaddr_t* prevhop, uint8_t hops)
 {
   struct neighbor* e;
-  if(addr_is_blocked(sender))
+  struct data_header hdr;
+  struct aggregate_reader r;
+  struct data_header rec;
+  linkaddr_t origin;
+  const uint8_t* payload;
+  uint8_t len;
+
+  if(!read_header(&hdr))
+    return;
+  e = find_neighbor(prevhop);
+  if(e == NULL || !link_sec_verify(&e->link_key, prevhop, hops))
+  {
+    printf("unauthenticated packet from %d.%d, dropped\n",
+      prevhop->u8[0], prevhop->u8[1]
+    );
+    return;
+  }
+  if(replayed(e, link_sec_replayed))
+  {
+    printf("replayed packet from %d.%d, dropped\n",
+      prevhop->u8[0], prevhop->u8[1]
+    );
+    return;
+  }
+  heard(e);
+  if(hdr.type == DATA_PLAIN)
+  {
+    deliver(sender, e, &hdr, (char *)packetbuf_dataptr() + sizeof(hdr));
+    return;
+  }
+
+  if(dup_cache_seen(sender, hdr.seqno, hdr.type))
+    return;
+  aggregate_reader_init(&r);
+  while(aggregate_reader_next(&r, &origin, &rec, &payload, &len))
+  {
+    // relays after the aggregating node count towards every record
+    rec.hops += hdr.hops;
+    if(len > 0 && payload[len - 1] == '\0')
+      deliver(&origin, e, &rec, (const char*)payload);
+  }
+}
+
+static int admit(const linkaddr_t* origin, struct neighbor* prevhop)
+{
+  if(rate_limit_admit(origin))
+    return 1;
+  sink_stats_shed(origin);
+  // the originator address is whatever the relays put there; only the
+  // previous hop is authenticated, and a relay is not to blame for the
+  // rate of the traffic it carries
+  if(linkaddr_cmp(origin, &prevhop->addr))
+    lower_trust(prevhop, SHED_PENALTY);
+  return 0;
+}
+
+static void deliver(const linkaddr_t* origin, struct neighbor* prevhop,
+  const struct data_header* hdr, const char* payload)
+{
+  struct neighbor* e;
+  if(addr_is_blocked(origin))
   {
     printf("Message from untrusted neighbor %d.%d, ignored\n",
-      sender->u8[0], sender->u8[1]
+      origin->u8[0], origin->u8[1]
+    );
+    return;
+  }
+  if(dup_cache_seen(origin, hdr->seqno, hdr->type))
+  {
+    printf("duplicate message from %d.%d, ignored\n",
+      origin->u8[0], origin->u8[1]
     );
     return;
   }
+  // only authenticated, fresh frames take tokens, so outsiders and
+  // replays cannot exhaust an originator's rate
+  if(!admit(origin, prevhop))
+    return;
 
   printf("multihop message from %d.%d received '%s'\n", 
-    sender->u8[0], sender->u8[1], (char *)packetbuf_dataptr()
+    origin->u8[0], origin->u8[1], payload
   );
+  sink_stats_record(origin, hdr->seqno, clock_time() - hdr->timestamp,
+    hdr->hops);
 
-  for(e = list_head(neighbor_table); e != NULL; e = e->next)
+  e = find_neighbor(origin);
+  if(e != NULL)
+    ctimer_set(&e->ctimer, NEIGHBOR_TIMEOUT, remove_neighbor, e);
+}
+
+static void send_queued(const linkaddr_t* nexthop, uint8_t remaining)
+{
+  struct neighbor* n = find_neighbor(nexthop);
+  if(n == NULL)
+    return;
+#if AGGREGATE_ENABLED
+  // a lone packet goes out unchanged, plain messages of a longer flush are
+  // collected and leave as one frame with the last packet of the flush
+  if(remaining > 0 || aggregate_count() > 0)
   {
-    if(linkaddr_cmp(sender, &e->addr))
+    if(aggregate_add())
     {
-      ctimer_set(&e->ctimer, NEIGHBOR_TIMEOUT, remove_neighbor, e);
+      if(remaining == 0)
+        send_aggregate(n);
+      return;
     }
   }
+#endif
+  if(seal_for(n))
+    send_sealed(n);
+#if AGGREGATE_ENABLED
+  if(remaining == 0 && aggregate_count() > 0)
+    send_aggregate(n);
+#endif
+}
+
+#if AGGREGATE_ENABLED
+static void send_aggregate(struct neighbor* n)
+{
+  struct data_header hdr;
+  printf("%d.%d: sending %d messages to %d.%d in one frame\n",
+    linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1], aggregate_count(),
+    n->addr.u8[0], n->addr.u8[1]);
+  hdr.seqno = ++aggregate_seqno;
+  hdr.timestamp = clock_time();
+  hdr.hops = 0;
+  hdr.type = DATA_AGGREGATE;
+  aggregate_to_packetbuf(&hdr);
+  // like any packet originated here, it dies if it loops back
+  dup_cache_seen(&linkaddr_node_addr, hdr.seqno, hdr.type);
+  if(seal_for(n))
+    send_sealed(n);
+}
+#endif
+
+static void send_sealed(struct neighbor* n)
+{
+#if RELIABLE_HOP_ENABLED
+  if(retx_budget(n) > 0 && reliable_hop_send(&n->addr, retx_budget(n)))
+    return;
+#endif
+  multihop_resend(&multihop, &n->addr);
+}
+
+#if RELIABLE_HOP_ENABLED
+static uint8_t retx_budget(const struct neighbor* n)
+{
+  return n->trust >= RELIABLE_TRUST ? RELIABLE_MAX_RETX : 0;
+}
+
+static void reliable_sent(const linkaddr_t* nexthop, uint8_t retransmissions)
+{
+  struct neighbor* n = find_neighbor(nexthop);
+  if(n != NULL)
+    link_quality_tx(&n->link, retransmissions);
+}
+
+static void reliable_input(const linkaddr_t* from)
+{
+  linkaddr_t originator, dest;
+  linkaddr_t* nexthop;
+  uint8_t hops = packetbuf_attr(PACKETBUF_ATTR_HOPS);
+
+  // copies, since forward() may rewrite packetbuf
+  linkaddr_copy(&originator, packetbuf_addr(PACKETBUF_ADDR_ESENDER));
+  linkaddr_copy(&dest, packetbuf_addr(PACKETBUF_ADDR_ERECEIVER));
+  if(linkaddr_cmp(&dest, &linkaddr_node_addr))
+  {
+    recv(&multihop, &originator, from, hops);
+    return;
+  }
+  packetbuf_set_attr(PACKETBUF_ATTR_HOPS, hops + 1);
+  nexthop = timed_forward(&multihop, &originator, &dest, from, hops);
+  if(nexthop != NULL)
+    multihop_resend(&multihop, nexthop);
+}
+
+static const linkaddr_t* reliable_reroute(const linkaddr_t* nexthop,
+  uint8_t* max_retx)
+{
+  struct neighbor* n = find_neighbor(nexthop);
+  if(n != NULL)
+    link_quality_failed(&n->link);
+  link_sec_unseal();
+  // a hop without retransmissions would time out right after sending
+  n = choose_next_hop(nexthop, RELIABLE_TRUST);
+  if(n == NULL || !seal_for(n))
+    return NULL;
+  printf("%d.%d: %d.%d did not acknowledge, rerouting to %d.%d\n",
+    linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],
+    nexthop->u8[0], nexthop->u8[1], n->addr.u8[0], n->addr.u8[1]);
+  *max_retx = retx_budget(n);
+  return &n->addr;
+}
+#endif
+
+static int next_hop_eligible(const struct neighbor* n, const linkaddr_t* skip, int min_trust)
+{
+  if(n->isolated || !n->link_key.valid || n->trust < min_trust)
+    return 0;
+  if(skip != NULL && linkaddr_cmp(skip, &n->addr))
+    return 0;
+#if BLOCKLIST_ENABLED
+  if(blocklist_is_blocked(&n->addr))
+    return 0;
+#endif
+  return 1;
+}
+
+static struct neighbor* choose_next_hop(const linkaddr_t* skip, int min_trust)
+{
+  int total = 0;
+  int num;
+  struct neighbor* n;
+
+  for(n = list_head(neighbor_table); n != NULL; n = n->next)
+    if(next_hop_eligible(n, skip, min_trust))
+      total += link_quality_weight(&n->link, n->trust);
+  if(total == 0)
+    // the skipped neighbor is still better than dropping the packet
+    return skip != NULL ? choose_next_hop(NULL, min_trust) : NULL;
+  num = random_rand() % total;
+  for(n = list_head(neighbor_table); n != NULL; n = n->next) {
+    if(!next_hop_eligible(n, skip, min_trust))
+      continue;
+    num -= link_quality_weight(&n->link, n->trust);
+    if(num < 0)
+      break;
+  }
+  return n;
+}
+
+static void heard(struct neighbor* n)
+{
+  link_quality_rx(&n->link);
+}
+
+static int replayed(struct neighbor* n,
+  int (*check)(struct anti_replay_info* info))
+{
+  if(check(&n->replay))
+  {
+    if(clock_seconds() - n->last_fresh < REPLAY_TIMEOUT)
+      return 1;
+    // without a flash snapshot a rebooted neighbor counts from 0 again,
+    // and would be dropped as a replay for good
+    printf("frame counter of %d.%d went back, starting over\n",
+      n->addr.u8[0], n->addr.u8[1]);
+    anti_replay_init_info(&n->replay);
+    check(&n->replay);
+  }
+  n->last_fresh = clock_seconds();
+  return 0;
+}
+
+static int seal_for(struct neighbor* n)
+{
+  if(link_sec_seal(&n->link_key, &n->addr))
+    return 1;
+  printf("%d.%d: no link key for %d.%d, dropped\n",
+    linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],
+    n->addr.u8[0], n->addr.u8[1]);
+  return 0;
 }
 
 static linkaddr_t* forward(struct multihop_conn* c, const linkaddr_t* originator, 
   const linkaddr_t* dest, const linkaddr_t* prevhop, uint8_t hops)
 {
   /* Find a random neighbor to send to. */
-  int num, i;
   struct neighbor *n;
+  struct data_header hdr;
+  // multihop_send passes no previous hop for packets originated here
+  const int relayed = prevhop != NULL && !linkaddr_cmp(prevhop, &linkaddr_node_addr);
 
-  if(!linkaddr_cmp(prevhop, &linkaddr_node_addr) && addr_is_blocked(prevhop))
+  if(relayed && addr_is_blocked(prevhop))
   {
     printf("packet from blocked neighbor %d.%d, dropped\n",
       prevhop->u8[0], prevhop->u8[1]
@@ -192,109 +862,210 @@ static linkaddr_t* forward(struct multihop_conn* c, const linkaddr_t* originator
     return NULL;
   }
 
+  if(relayed)
+  {
+    n = find_neighbor(prevhop);
+    if(n == NULL || !link_sec_verify(&n->link_key, prevhop, hops))
+    {
+      printf("unauthenticated packet from %d.%d, dropped\n",
+        prevhop->u8[0], prevhop->u8[1]
+      );
+      return NULL;
+    }
+    if(replayed(n, link_sec_replayed))
+    {
+      printf("replayed packet from %d.%d, dropped\n",
+        prevhop->u8[0], prevhop->u8[1]
+      );
+      return NULL;
+    }
+    heard(n);
+  }
+
+  // originated packets are recorded too, so they die if they loop back here
+  if(!read_header(&hdr) || dup_cache_seen(originator, hdr.seqno, hdr.type))
+  {
+    printf("duplicate packet from %d.%d via %d.%d, dropped\n",
+      originator->u8[0], originator->u8[1],
+      relayed ? prevhop->u8[0] : 0, relayed ? prevhop->u8[1] : 0
+    );
+    return NULL;
+  }
+
   for(n = list_head(neighbor_table); n != NULL; n = n->next)
   {
-    if(linkaddr_cmp(prevhop, &n->addr))
+    if(relayed && linkaddr_cmp(prevhop, &n->addr))
     {
       ctimer_set(&n->ctimer, NEIGHBOR_TIMEOUT, remove_neighbor, n);
-      if(clock_seconds() - n->last_received < MINIMUM_DELAY && n->trust > 49)
+      if(clock_seconds() - n->last_received < params.minimum_delay
+         && n->trust >= params.mat)
         n->trust *= 0.99;
       n->last_received = clock_seconds();
+      check_isolation(n);
     }
   }
 
-  if(list_length(neighbor_table) > 0) {
-    num = random_rand() % list_length(neighbor_table);
-    i = 0;
-    for(n = list_head(neighbor_table); n != NULL && i != num; n = n->next) {
-      ++i;
+  if(!linkaddr_cmp(originator, &linkaddr_node_addr)
+     && attack_drop_forward(originator))
+  {
+    printf("%s: dropping packet from %d.%d\n", attack_name(),
+      originator->u8[0], originator->u8[1]
+    );
+    return NULL;
+  }
+
+  // never hand a packet straight back to the previous hop unless it is
+  // the only neighbor
+#if RELIABLE_HOP_ENABLED
+  // hops trusted with retransmissions first, the others only best effort
+  n = choose_next_hop(relayed ? prevhop : NULL, RELIABLE_TRUST);
+  if(n == NULL)
+    n = choose_next_hop(relayed ? prevhop : NULL, 0);
+#else
+  n = choose_next_hop(relayed ? prevhop : NULL, 0);
+#endif
+  if(n != NULL) {
+    if(relayed) {
+      hdr.hops++;
+      write_header(&hdr);
     }
-    if(n != NULL) {
-      printf("%d.%d: Forwarding packet to %d.%d (%d in list), hops %d\n",
+    printf("%d.%d: Forwarding packet to %d.%d (%d in list), hops %d\n",
 	     linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1],
-	     n->addr.u8[0], n->addr.u8[1], num,
+	     n->addr.u8[0], n->addr.u8[1], list_length(neighbor_table),
 	     packetbuf_attr(PACKETBUF_ATTR_HOPS));
-      return &n->addr;
+#if FWD_QUEUE_ENABLED
+    // the queue seals and sends it later, so multihop must not send it now
+    {
+      struct neighbor* from = relayed ? find_neighbor(prevhop) : NULL;
+      if(fwd_queue_enqueue(&n->addr, from != NULL ? from->trust : 100))
+        return NULL;
     }
+#endif
+    if(!seal_for(n))
+      return NULL;
+#if RELIABLE_HOP_ENABLED
+    if(retx_budget(n) > 0 && reliable_hop_send(&n->addr, retx_budget(n)))
+      return NULL;
+#endif
+    return &n->addr;
   }
   printf("%d.%d: did not find a neighbor to foward to\n",
 	 linkaddr_node_addr.u8[0], linkaddr_node_addr.u8[1]);
   return NULL;
 }
-/*
-static void broadcast_recv(struct broadcast_conn *c, const linkaddr_t *from)
-{
-  struct neighbor_trust nt[MAX_NEIGHBORS] = {};
-  int i;
-  struct neighbor* e;
-  
-  packetbuf_copyto(nt);
-  printf("Broadcast from %d.%d: ", from->u8[0], from->u8[1]);
-  for(i = 0; i < MAX_NEIGHBORS; i++)
-  {
-    printf("%d.%d %d | ", nt[i].addr.u8[0], nt[i].addr.u8[1], nt[i].trust);
-  }
-  printf("\n");
-
-  for(e = list_head(neighbor_table); e != NULL; e = e->next) {
-    if(linkaddr_cmp(from, &e->addr)) {
-      ctimer_set(&e->ctimer, NEIGHBOR_TIMEOUT, remove_neighbor, e);
-      return;
-    }
-  }
-  e = memb_alloc(&neighbor_mem);
-  if(e != NULL) {
-    linkaddr_copy(&e->addr, from);
-    list_add(neighbor_table, e);
-    ctimer_set(&e->ctimer, NEIGHBOR_TIMEOUT, remove_neighbor, e);
-    e->trust = 100;
-    e->last_received = clock_seconds();
-  }
-}*/
 static void broadcast_recv(struct broadcast_conn *c, const linkaddr_t *from)
 {
-  struct neighbor_trust nt[MAX_NEIGHBORS] = {};
   struct neighbor* e;
   printf("Broadcast from %d.%d \n", from->u8[0], from->u8[1]);
+  if(!trust_auth_verify(from)) {
+    printf("unauthenticated trust vector from %d.%d, dropped\n",
+      from->u8[0], from->u8[1]);
+    return;
+  }
   for(e = list_head(neighbor_table); e != NULL; e = e->next) {
     if(linkaddr_cmp(from, &e->addr)) {
-	if(e->trust<50){
+	if(e->trust < params.mat){
 		return;	
 	}
-	else{
-		packetbuf_copyto(nt);
-  		update_table(&nt);
+	if(replayed(e, trust_auth_replayed)){
+		printf("replayed trust vector from %d.%d, dropped\n",
+		  from->u8[0], from->u8[1]);
 		return;
-	}     
+	}
+	heard(e);
+	ctimer_set(&e->ctimer, NEIGHBOR_TIMEOUT, remove_neighbor, e);
+#if CLUSTER_ENABLED
+	if(!cluster_accepts(from))
+	  return;
+#endif
+#if TRUST_SYNC_ENABLED
+	sync_input(e);
+#else
+	update_table();
+#endif
+	return;
     }
   }  
-  e = memb_alloc(&neighbor_mem); 
+  e = add_neighbor(from);
+  // a full table has no room to merge the vector into either
+  if(e == NULL)
+    return;
+  trust_auth_replayed(&e->replay);
+  heard(e);
+#if CLUSTER_ENABLED
+  if(!cluster_accepts(from))
+    return;
+#endif
+#if TRUST_SYNC_ENABLED
+  sync_input(e);
+#else
+  update_table();
+#endif
+}
+
+static linkaddr_t* timed_forward(struct multihop_conn* c,
+  const linkaddr_t* originator, const linkaddr_t* dest,
+  const linkaddr_t* prevhop, uint8_t hops)
+{
+  linkaddr_t* nexthop;
+  PROFILE_BEGIN(PROFILE_FORWARD);
+  nexthop = forward(c, originator, dest, prevhop, hops);
+  PROFILE_END(PROFILE_FORWARD);
+  return nexthop;
+}
+
+static void timed_broadcast_recv(struct broadcast_conn *c,
+  const linkaddr_t *from)
+{
+  PROFILE_BEGIN(PROFILE_BROADCAST_RECV);
+  broadcast_recv(c, from);
+  PROFILE_END(PROFILE_BROADCAST_RECV);
+}
+
+static void discovery_recv(struct neighbor_discovery_conn *c,
+  const linkaddr_t *from, uint16_t val)
+{
+  struct neighbor* e;
+#if CLUSTER_ENABLED
+  uint8_t is_head = cluster_beacon_head(&val);
+#endif
+  e = find_neighbor(from);
   if(e != NULL) {
-    linkaddr_copy(&e->addr, from);
-    list_add(neighbor_table, e);
-    e->trust = 100;
-    e->last_received = clock_seconds();
+    heard(e);
+#if CLUSTER_ENABLED
+    e->head = is_head;
+#endif
     ctimer_set(&e->ctimer, NEIGHBOR_TIMEOUT, remove_neighbor, e);
+    // the sender is still bootstrapping, beacon fast until it knows us
+    if(val == 0)
+      neighbor_discovery_start(&discovery, beacon_val());
+    return;
   }
-  packetbuf_copyto(nt);
-  update_table(&nt);
+  // anyone can send a beacon, so the entry waits for a trust broadcast
+  printf("Discovered %d.%d\n", from->u8[0], from->u8[1]);
+  introduce = 1;
 }
 /* HELPER FUNCTIONS */
 
-static void update_table(void* _nt){
-  struct neighbor_trust *nt=_nt;
-  int i;
+static void update_table(void){
+  struct trust_reader r;
+  struct neighbor_trust nt;
   struct neighbor* e;
+  PROFILE_BEGIN(PROFILE_UPDATE_TABLE);
   printf("received neighbor trusts: ");
-  for(i = 0; i < MAX_NEIGHBORS; i++){
-   if(nt[i].trust==0)
-	break;
-   printf("%d.%d %d ", nt[i].addr.u8[0], nt[i].addr.u8[1], nt[i].trust);
+  trust_reader_init(&r);
+  while(trust_reader_next(&r, &nt)){
+   printf("%d.%d %d ", nt.addr.u8[0], nt.addr.u8[1], nt.trust);
    for(e = list_head(neighbor_table); e != NULL; e = e->next) {
-    if(linkaddr_cmp(&nt[i].addr, &e->addr)) {
-	if(nt[i].trust!=e->trust){
-   	e->trust=(e->trust+nt[i].trust)/2;
+    if(linkaddr_cmp(&nt.addr, &e->addr)) {
+	if(nt.trust!=e->trust){
+   	e->trust=(e->trust+nt.trust)/2;
 		}    	
+#if CLUSTER_ENABLED
+	// members only merge the summaries of their head
+	if(!cluster_is_head())
+	  e->head_trust = nt.trust;
+#endif
     }
     if(linkaddr_cmp(&e->addr, &sink_addr))
       e->trust = 100;
@@ -302,9 +1073,66 @@ static void update_table(void* _nt){
  }
   printf("\nown neighbor trusts: ");
   for(e = list_head(neighbor_table); e != NULL; e = e->next) {
-    printf(" %d.%d %d | ", e->addr.u8[0], e->addr.u8[1], e->trust);
+    printf(" %d.%d %d rssi %d lqi %u etx %u | ", e->addr.u8[0], e->addr.u8[1],
+      e->trust, e->link.rssi, e->link.lqi, e->link.etx);
   }
   printf("\n");
+  for(e = list_head(neighbor_table); e != NULL; e = e->next) {
+    check_isolation(e);
+  }
+  PROFILE_END(PROFILE_UPDATE_TABLE);
+}
+
+static enum node_role select_role(void)
+{
+#ifdef ROLE
+  return ROLE;
+#else
+  if(node_id == MALICIOUS_NODE_ID)
+    return MALICIOUS_ROLE;
+  return ROLE_HONEST;
+#endif
+}
+
+static void trust_reader_init(struct trust_reader *r)
+{
+  r->pos = packetbuf_dataptr();
+  r->end = r->pos + packetbuf_datalen();
+}
+
+static int trust_reader_next(struct trust_reader *r, struct neighbor_trust *nt)
+{
+  if(r->pos + sizeof(*nt) > r->end)
+    return 0;
+  // packetbuf data is not necessarily word aligned, so the record is
+  // copied out rather than dereferenced in place
+  memcpy(nt, r->pos, sizeof(*nt));
+  r->pos += sizeof(*nt);
+  return nt->trust != 0;
+}
+
+static struct neighbor* find_neighbor(const linkaddr_t* a)
+{
+  struct neighbor* n;
+  for(n = list_head(neighbor_table); n != NULL; n = n->next)
+  {
+    if(linkaddr_cmp(a, &n->addr))
+      return n;
+  }
+  return NULL;
+}
+
+static int read_header(struct data_header* h)
+{
+  if(packetbuf_datalen() < sizeof(*h))
+    return 0;
+  memcpy(h, packetbuf_dataptr(), sizeof(*h));
+  return 1;
+}
+
+static void write_header(const struct data_header* h)
+{
+  memcpy(packetbuf_dataptr(), h, sizeof(*h));
 }
 
 static int addr_is_blocked(const linkaddr_t* a)
@@ -312,12 +1140,572 @@ static int addr_is_blocked(const linkaddr_t* a)
   struct neighbor* n;
   for(n = list_head(neighbor_table); n != NULL; n = n->next)
   {
-    if(linkaddr_cmp(a, &n->addr) && n->trust < MAT)
+    if(linkaddr_cmp(a, &n->addr) && n->trust < params.mat)
     {
       return 1;
     }
   }
+#if BLOCKLIST_ENABLED
+  return blocklist_is_blocked(a);
+#else
   return 0;
+#endif
+}
+
+static void lower_trust(struct neighbor* n, int amount)
+{
+  n->trust = n->trust > amount ? n->trust - amount : 1;
+  check_isolation(n);
+}
+
+static void check_isolation(struct neighbor* n)
+{
+#if JOURNAL_ENABLED
+  if(n->trust >= n->journaled_trust + JOURNAL_TRUST_STEP
+     || n->trust + JOURNAL_TRUST_STEP <= n->journaled_trust)
+  {
+    journal_add(JOURNAL_TRUST, &n->addr, n->trust);
+    n->journaled_trust = n->trust;
+  }
+#endif
+  if(!n->isolated && n->trust < params.mat)
+  {
+    n->isolated = 1;
+#if JOURNAL_ENABLED
+    journal_add(JOURNAL_ISOLATED, &n->addr, n->trust);
+#endif
+    link_sec_revoke(&n->link_key);
+    link_filter_block(&n->addr);
+    printf("ISOLATED %d.%d after %lu s\n", n->addr.u8[0], n->addr.u8[1],
+      clock_seconds() - n->first_seen);
+#if BLOCKLIST_ENABLED
+    publish_blocklist();
+#endif
+  }
+  else if(n->isolated && n->trust >= params.mat)
+  {
+    n->isolated = 0;
+#if JOURNAL_ENABLED
+    journal_add(JOURNAL_RESTORED, &n->addr, n->trust);
+#endif
+    printf("RESTORED %d.%d after %lu s\n", n->addr.u8[0], n->addr.u8[1],
+      clock_seconds() - n->first_seen);
+#if BLOCKLIST_ENABLED
+    publish_blocklist();
+    // still blocked by the rest of the network
+    if(blocklist_is_blocked(&n->addr))
+      return;
+#endif
+    link_sec_derive(&n->link_key, &n->addr);
+    link_filter_unblock(&n->addr);
+  }
+}
+
+static struct neighbor* add_neighbor(const linkaddr_t* a)
+{
+  struct neighbor* e = memb_alloc(&neighbor_mem);
+  if(e == NULL)
+    return NULL;
+  linkaddr_copy(&e->addr, a);
+  list_add(neighbor_table, e);
+  e->trust = 100;
+  e->last_received = clock_seconds();
+  e->first_seen = e->last_received;
+  e->isolated = 0;
+  e->journaled_trust = e->trust;
+#if JOURNAL_ENABLED
+  journal_add(JOURNAL_NEIGHBOR, a, e->trust);
+#endif
+  anti_replay_init_info(&e->replay);
+  e->last_fresh = e->last_received;
+  link_sec_clear(&e->link_key);
+  if(!link_sec_derive(&e->link_key, a))
+    printf("no link key for %d.%d, bootstrap is over\n", a->u8[0], a->u8[1]);
+  link_quality_init(&e->link);
+#if CLUSTER_ENABLED
+  e->head = 0;
+  e->head_trust = e->trust;
+#endif
+#if TRUST_SYNC_ENABLED
+  // versioned by the next sync_versions()
+  e->version = 0;
+  e->synced_trust = 0;
+  e->synced_clock = 0;
+  e->digest_clock = 0;
+  e->sync_request = 0;
+#endif
+  ctimer_set(&e->ctimer, NEIGHBOR_TIMEOUT, remove_neighbor, e);
+  // the table changed, advertise it quickly again
+  neighbor_discovery_start(&discovery, beacon_val());
+  return e;
+}
+
+#if TRUST_STORE_ENABLED
+static void restore_table(void)
+{
+  struct neighbor* e;
+  int i, count;
+  uint32_t counter;
+
+  count = trust_store_load(store_records, TRUST_STORE_MAX_RECORDS, &counter);
+  trust_auth_resume(counter);
+  for(i = 0; i < count; i++)
+  {
+    e = add_neighbor(&store_records[i].addr);
+    if(e == NULL)
+      break;
+    e->trust = store_records[i].trust;
+    if(!store_records[i].isolated)
+    {
+      check_isolation(e);
+      continue;
+    }
+    // isolated under the MAT in force before the reboot, which may have
+    // been higher; it stays blocked until its trust is next evaluated
+    e->isolated = 1;
+#if JOURNAL_ENABLED
+    journal_add(JOURNAL_ISOLATED, &e->addr, e->trust);
+#endif
+    link_sec_revoke(&e->link_key);
+    link_filter_block(&e->addr);
+    printf("ISOLATED %d.%d again after reboot\n", e->addr.u8[0], e->addr.u8[1]);
+  }
+#if BLOCKLIST_ENABLED
+  publish_blocklist();
+#endif
+  if(count > 0)
+    printf("restored %d neighbors from flash\n", count);
+}
+
+static void store_table(void* ptr)
+{
+  struct neighbor* e;
+  int count = 0;
+
+  for(e = list_head(neighbor_table);
+      e != NULL && count < TRUST_STORE_MAX_RECORDS; e = e->next, count++)
+  {
+    linkaddr_copy(&store_records[count].addr, &e->addr);
+    store_records[count].trust = e->trust;
+    store_records[count].isolated = e->isolated;
+  }
+  if(trust_store_save(store_records, count, trust_auth_reserve()))
+    printf("trust table stored\n");
+  ctimer_set(&store_timer, STORE_INTERVAL, store_table, NULL);
+}
+#endif
+
+// get                     prints the trust parameters
+// set mat|mindelay|period N changes one, isolation is rechecked at once
+// table                   dumps the neighbor table
+// stats                   dumps the sink statistics and queue counters
+// stack                   prints the deepest stack use since boot
+// journal                 streams the trust journal
+// profile [reset]         prints or clears the hot path timings
+static void run_command(char* line)
+{
+  struct neighbor* n;
+  char* name;
+  char* arg;
+  int value;
+
+  if(strcmp(line, "get") == 0)
+  {
+    print_params();
+    return;
+  }
+  if(strcmp(line, "table") == 0)
+  {
+    dump_table();
+    return;
+  }
+#if STACK_MARK_ENABLED
+  if(strcmp(line, "stack") == 0)
+  {
+    printf("STACK used %u of %u\n", stack_mark_used(), stack_mark_size());
+    return;
+  }
+#endif
+  if(strcmp(line, "stats") == 0)
+  {
+    if(linkaddr_cmp(&linkaddr_node_addr, &sink_addr))
+      sink_stats_dump();
+    fwd_queue_report();
+    printf("filtered %u refused %u overflow %u\n", link_filter_dropped(),
+      mac_blacklist_refused(), link_filter_overflow());
+    printf("trust tx %u frames %lu bytes\n", trust_frames,
+      (unsigned long)trust_bytes);
+#if CLUSTER_ENABLED
+    printf("cluster head %d.%d\n", cluster_head()->u8[0],
+      cluster_head()->u8[1]);
+#endif
+    return;
+  }
+#if BLOCKLIST_ENABLED
+  if(strcmp(line, "blocklist") == 0)
+  {
+    blocklist_report();
+    return;
+  }
+#endif
+#if JOURNAL_ENABLED
+  if(strcmp(line, "journal") == 0)
+  {
+    journal_dump();
+    return;
+  }
+#endif
+#if PROFILE_ENABLED
+  if(strcmp(line, "profile") == 0)
+  {
+    profile_report();
+    return;
+  }
+  if(strcmp(line, "profile reset") == 0)
+  {
+    profile_reset();
+    return;
+  }
+#endif
+  if(strncmp(line, "set ", 4) == 0)
+  {
+    name = line + 4;
+    arg = strchr(name, ' ');
+    value = arg != NULL ? atoi(arg + 1) : -1;
+    if(strncmp(name, "mat ", 4) == 0 && value > 0 && value <= 100)
+    {
+      params.mat = value;
+      for(n = list_head(neighbor_table); n != NULL; n = n->next)
+        check_isolation(n);
+#if BLOCKLIST_ENABLED
+      // MAT decides whose lists count
+      blocklist_reevaluate();
+#endif
+    }
+    else if(strncmp(name, "mindelay ", 9) == 0 && value >= 0 && value <= 255)
+      params.minimum_delay = value;
+    else if(strncmp(name, "period ", 7) == 0 && value > 0 && value <= 60)
+      params.broadcast_period = value;
+    else
+    {
+      printf("bad parameter '%s'\n", name);
+      return;
+    }
+    print_params();
+    return;
+  }
+  printf("unknown command '%s'\n", line);
+}
+
+#if !TRUST_SYNC_ENABLED
+static void write_vector(void)
+{
+  struct neighbor_trust nt;
+  struct neighbor* n;
+  uint8_t* pos;
+  uint16_t i = 0;
+  uint16_t count = 0;
+
+  packetbuf_clear();
+  pos = packetbuf_dataptr();
+  for(n = list_head(neighbor_table); n != NULL && i < vector_start; n = n->next)
+    i++;
+  if(n == NULL)
+  {
+    n = list_head(neighbor_table);
+    i = 0;
+  }
+  for(; n != NULL && count < TRUST_VECTOR_MAX; n = n->next, i++)
+  {
+    nt.trust = attack_advertised_trust(&n->addr, n->trust);
+#if CLUSTER_ENABLED
+    if(!cluster_advertised(n, nt.trust))
+      continue;
+#endif
+    nt.addr = n->addr;
+    memcpy(pos, &nt, sizeof(nt));
+    pos += sizeof(nt);
+    count++;
+  }
+  vector_start = n != NULL ? i : 0;
+  // only the filled records, the receiver stops at the end of the data
+  packetbuf_set_datalen(count * sizeof(nt));
+}
+#endif
+
+static void send_trust(void)
+{
+  attack_spoof_begin();
+  if(trust_auth_seal())
+  {
+    trust_frames++;
+    trust_bytes += packetbuf_totlen();
+    broadcast_send(&broadcast);
+  }
+  attack_spoof_end();
+}
+
+#if TRUST_SYNC_ENABLED
+static void sync_versions(void)
+{
+  struct neighbor* n;
+  uint8_t trust;
+  for(n = list_head(neighbor_table); n != NULL; n = n->next)
+  {
+    trust = attack_advertised_trust(&n->addr, n->trust);
+    if(trust != n->synced_trust)
+    {
+      n->synced_trust = trust;
+      n->version = ++table_clock;
+    }
+  }
+}
+
+static void write_sync_header(uint8_t type, const linkaddr_t* target,
+  uint16_t since, uint16_t clock)
+{
+  struct trust_sync_header hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.type = type;
+  if(target != NULL)
+    linkaddr_copy(&hdr.target, target);
+  hdr.since = since;
+  hdr.clock = clock;
+  packetbuf_clear();
+  memcpy(packetbuf_dataptr(), &hdr, sizeof(hdr));
+  packetbuf_set_datalen(sizeof(hdr));
+}
+
+static void write_entries(uint16_t since)
+{
+  struct neighbor_trust nt;
+  struct neighbor* n;
+  uint8_t* pos;
+  uint16_t upto = table_clock;
+  uint16_t next;
+  uint16_t count = 0;
+
+  for(n = list_head(neighbor_table); n != NULL; n = n->next)
+  {
+    if(n->version > since)
+      count++;
+  }
+  // versions are unique, so the response ends at the SYNC_ENTRIES_MAXth
+  // oldest change and the requester asks again from there
+  if(count > SYNC_ENTRIES_MAX)
+  {
+    upto = since;
+    for(count = 0; count < SYNC_ENTRIES_MAX; count++)
+    {
+      next = 0xffff;
+      for(n = list_head(neighbor_table); n != NULL; n = n->next)
+      {
+        if(n->version > upto && n->version < next)
+          next = n->version;
+      }
+      upto = next;
+    }
+  }
+
+  write_sync_header(TRUST_SYNC_ENTRIES, NULL, since, upto);
+  pos = (uint8_t*)packetbuf_dataptr() + sizeof(struct trust_sync_header);
+  count = 0;
+  for(n = list_head(neighbor_table); n != NULL; n = n->next)
+  {
+    if(n->version <= since || n->version > upto)
+      continue;
+    nt.addr = n->addr;
+    nt.trust = n->synced_trust;
+    memcpy(pos, &nt, sizeof(nt));
+    pos += sizeof(nt);
+    count++;
+  }
+  packetbuf_set_datalen(sizeof(struct trust_sync_header)
+    + count * sizeof(nt));
+}
+
+static void sync_input(struct neighbor* e)
+{
+  struct trust_sync_header hdr;
+  if(packetbuf_datalen() < sizeof(hdr))
+    return;
+  memcpy(&hdr, packetbuf_dataptr(), sizeof(hdr));
+  switch(hdr.type)
+  {
+  case TRUST_SYNC_DIGEST:
+    e->digest_clock = hdr.clock;
+    if(hdr.clock != e->synced_clock && !e->sync_request)
+    {
+      e->sync_request = 1;
+      sync_schedule();
+    }
+    break;
+  case TRUST_SYNC_REQUEST:
+    if(!linkaddr_cmp(&hdr.target, &linkaddr_node_addr))
+      break;
+    // one response serves every neighbor that asked meanwhile
+    if(!respond_pending || hdr.since < respond_since)
+      respond_since = hdr.since;
+    respond_pending = 1;
+    sync_schedule();
+    break;
+  case TRUST_SYNC_ENTRIES:
+    // update_table() averages, so every change is merged once: responses
+    // to other neighbors count only if they continue our copy, a full one
+    // only once the neighbor's clock went back
+    if(hdr.since != e->synced_clock
+       && !(hdr.since == 0 && e->digest_clock < e->synced_clock))
+      break;
+    packetbuf_hdrreduce(sizeof(hdr));
+    update_table();
+    e->synced_clock = hdr.clock;
+    break;
+  }
+}
+
+static void sync_send(void* ptr)
+{
+  struct neighbor* n;
+  if(respond_pending)
+  {
+    respond_pending = 0;
+    write_entries(respond_since);
+    send_trust();
+  }
+  else
+  {
+    for(n = list_head(neighbor_table); n != NULL; n = n->next)
+    {
+      if(!n->sync_request)
+        continue;
+      n->sync_request = 0;
+      // a response overheard since the digest may have caught us up
+      if(n->digest_clock == n->synced_clock)
+        continue;
+      // a clock behind our copy means the neighbor rebooted
+      write_sync_header(TRUST_SYNC_REQUEST, &n->addr,
+        n->digest_clock < n->synced_clock ? 0 : n->synced_clock, 0);
+      send_trust();
+      break;
+    }
+  }
+  for(n = list_head(neighbor_table); n != NULL && !n->sync_request;
+      n = n->next);
+  if(respond_pending || n != NULL)
+    sync_schedule();
+}
+
+static void sync_schedule(void)
+{
+  if(ctimer_expired(&sync_timer))
+    ctimer_set(&sync_timer, TRUST_SYNC_SPACING
+      + random_rand() % TRUST_SYNC_SPACING, sync_send, NULL);
+}
+#endif
+
+static uint16_t beacon_val(void)
+{
+#if CLUSTER_ENABLED
+  return cluster_beacon_val(list_length(neighbor_table));
+#else
+  return list_length(neighbor_table);
+#endif
+}
+
+#if CLUSTER_ENABLED
+static void elect_head(void)
+{
+  struct neighbor* n;
+  cluster_elect_begin();
+  for(n = list_head(neighbor_table); n != NULL; n = n->next)
+  {
+    if(n->head && !n->isolated)
+      cluster_candidate(&n->addr);
+  }
+  if(!cluster_elect_end())
+    return;
+  // opinions of the old head say nothing about the new one's
+  for(n = list_head(neighbor_table); n != NULL; n = n->next)
+    n->head_trust = 100;
+  neighbor_discovery_start(&discovery, beacon_val());
+}
+
+static int cluster_advertised(struct neighbor* n, int trust)
+{
+  if(cluster_is_head())
+    return trust < CLUSTER_SUSPECT_TRUST;
+  if(abs(trust - n->head_trust) < CLUSTER_REPORT_DELTA)
+    return 0;
+  // heads do not list the nodes they trust, so a report of a trusted node
+  // is never confirmed by a summary; assume the head follows it
+  if(trust >= CLUSTER_SUSPECT_TRUST)
+    n->head_trust = trust;
+  return 1;
+}
+#endif
+
+#if BLOCKLIST_ENABLED
+static void publish_blocklist(void)
+{
+  linkaddr_t accused[BLOCKLIST_MAX_ACCUSED];
+  struct neighbor* n;
+  uint8_t count = 0;
+  for(n = list_head(neighbor_table);
+      n != NULL && count < BLOCKLIST_MAX_ACCUSED; n = n->next)
+  {
+    if(n->isolated)
+      linkaddr_copy(&accused[count++], &n->addr);
+  }
+  blocklist_publish(accused, count);
+}
+
+static int blocklist_trusted(const linkaddr_t* a)
+{
+  struct neighbor* n = find_neighbor(a);
+  return n != NULL && !n->isolated && n->trust >= params.mat;
+}
+
+static void blocklist_changed(const linkaddr_t* a, uint8_t blocked)
+{
+  struct neighbor* n = find_neighbor(a);
+  printf("%s %d.%d network-wide\n", blocked ? "BLOCKED" : "RELEASED",
+    a->u8[0], a->u8[1]);
+#if JOURNAL_ENABLED
+  journal_add(blocked ? JOURNAL_BLOCKED : JOURNAL_RELEASED, a,
+    n != NULL ? n->trust : 0);
+#endif
+  if(blocked)
+  {
+    link_filter_block(a);
+    if(n != NULL)
+      link_sec_revoke(&n->link_key);
+  }
+  // our own verdict still stands for a neighbor we isolated
+  else if(n == NULL || !n->isolated)
+  {
+    link_filter_unblock(a);
+    if(n != NULL)
+      link_sec_derive(&n->link_key, a);
+  }
+}
+#endif
+
+static void print_params(void)
+{
+  printf("P mat %u mindelay %u period %u\n", params.mat,
+    params.minimum_delay, params.broadcast_period);
+}
+
+static void dump_table(void)
+{
+  struct neighbor* n;
+  printf("T ");
+  for(n = list_head(neighbor_table); n != NULL; n = n->next)
+  {
+    printf("%02x%02x%02x%02x%02x%02x", n->addr.u8[0], n->addr.u8[1],
+      n->trust, n->isolated, n->link.etx & 0xff, n->link.etx >> 8);
+  }
+  printf("\n");
 }
 
 static void remove_neighbor(void* _n)
@@ -326,14 +1714,21 @@ static void remove_neighbor(void* _n)
   if(linkaddr_cmp(&sink_addr, &n->addr))
     return;
 
-  if (n->trust >= MAT)
+  if (n->isolated)
   {
-    //n->trust *= 0.99;
-    ctimer_set(&n->ctimer, NEIGHBOR_TIMEOUT, remove_neighbor, n);
+    printf("Trust of %d.%d fell below %d\n", n->addr.u8[0], n->addr.u8[1],
+      params.mat);
     return;
   }
-  else
-    printf("Trust of %d.%d fell below 50\n", n->addr.u8[0], n->addr.u8[1]);
+  printf("%d.%d went silent, removed\n", n->addr.u8[0], n->addr.u8[1]);
+  list_remove(neighbor_table, n);
+  memb_free(&neighbor_mem, n);
+#if BLOCKLIST_ENABLED
+  // its list no longer counts
+  blocklist_reevaluate();
+#endif
+  // the table changed, advertise it quickly again
+  neighbor_discovery_start(&discovery, beacon_val());
 }
 
 
@@ -0,0 +1,94 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "data-header.h"
+#include "aggregate.h"
+
+#include <string.h>
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// bytes of a record in front of its payload
+#define RECORD_HEADER_LEN (LINKADDR_SIZE + sizeof(struct data_header) + 1)
+
+/* GLOBAL VARIABLES */
+// records collected so far, the outer header is added when sending
+static uint8_t records[AGGREGATE_MAX_PAYLOAD - sizeof(struct data_header)];
+static uint8_t records_len;
+static uint8_t count;
+// final destination shared by the collected messages
+static linkaddr_t dest;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+int aggregate_add(void)
+{
+  struct data_header hdr;
+  const uint8_t* data = packetbuf_dataptr();
+  uint16_t len = packetbuf_datalen();
+  uint8_t* r;
+
+  if(len < sizeof(hdr))
+    return 0;
+  memcpy(&hdr, data, sizeof(hdr));
+  len -= sizeof(hdr);
+  if(hdr.type != DATA_PLAIN
+     || records_len + RECORD_HEADER_LEN + len > sizeof(records))
+    return 0;
+  if(count > 0 && !linkaddr_cmp(&dest, packetbuf_addr(PACKETBUF_ADDR_ERECEIVER)))
+    return 0;
+
+  linkaddr_copy(&dest, packetbuf_addr(PACKETBUF_ADDR_ERECEIVER));
+  r = records + records_len;
+  memcpy(r, packetbuf_addr(PACKETBUF_ADDR_ESENDER), LINKADDR_SIZE);
+  memcpy(r + LINKADDR_SIZE, &hdr, sizeof(hdr));
+  r[LINKADDR_SIZE + sizeof(hdr)] = len;
+  memcpy(r + RECORD_HEADER_LEN, data + sizeof(hdr), len);
+  records_len += RECORD_HEADER_LEN + len;
+  count++;
+  return 1;
+}
+
+uint8_t aggregate_count(void)
+{
+  return count;
+}
+
+void aggregate_to_packetbuf(const struct data_header* hdr)
+{
+  uint8_t* data;
+
+  packetbuf_clear();
+  data = packetbuf_dataptr();
+  memcpy(data, hdr, sizeof(*hdr));
+  memcpy(data + sizeof(*hdr), records, records_len);
+  packetbuf_set_datalen(sizeof(*hdr) + records_len);
+  // the same attributes multihop_send sets for a packet originated here
+  packetbuf_set_addr(PACKETBUF_ADDR_ERECEIVER, &dest);
+  packetbuf_set_addr(PACKETBUF_ADDR_ESENDER, &linkaddr_node_addr);
+  packetbuf_set_attr(PACKETBUF_ATTR_HOPS, 1);
+  records_len = 0;
+  count = 0;
+}
+
+void aggregate_reader_init(struct aggregate_reader* r)
+{
+  r->pos = (const uint8_t*)packetbuf_dataptr() + sizeof(struct data_header);
+  r->end = (const uint8_t*)packetbuf_dataptr() + packetbuf_datalen();
+}
+
+int aggregate_reader_next(struct aggregate_reader* r, linkaddr_t* originator,
+  struct data_header* hdr, const uint8_t** payload, uint8_t* len)
+{
+  if(r->pos + RECORD_HEADER_LEN > r->end)
+    return 0;
+  memcpy(originator, r->pos, LINKADDR_SIZE);
+  memcpy(hdr, r->pos + LINKADDR_SIZE, sizeof(*hdr));
+  *len = r->pos[LINKADDR_SIZE + sizeof(*hdr)];
+  if(r->pos + RECORD_HEADER_LEN + *len > r->end)
+    return 0;
+  *payload = r->pos + RECORD_HEADER_LEN;
+  r->pos += RECORD_HEADER_LEN + *len;
+  return 1;
+}
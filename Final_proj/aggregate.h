@@ -0,0 +1,47 @@
+#ifndef AGGREGATE_H_
+#define AGGREGATE_H_
+
+#include "net/rime/rime.h"
+#include "data-header.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// set to 0 to send every queued message in its own frame
+#ifndef AGGREGATE_ENABLED
+#define AGGREGATE_ENABLED 1
+#endif
+// largest aggregate payload, leaving room in the 127-byte 802.15.4 frame
+// for the MAC header and FCS, the Rime multihop header and the link MIC
+#ifndef AGGREGATE_MAX_PAYLOAD
+#define AGGREGATE_MAX_PAYLOAD 96
+#endif
+
+/* STRUCTS */
+// cursor over the records of a received aggregate
+// an aggregate is a data_header of type DATA_AGGREGATE followed by records
+// of originator address, the message's data_header, payload length, payload
+struct aggregate_reader
+{
+  const uint8_t* pos;
+  const uint8_t* end;
+};
+
+/* FUNCTIONS */
+// appends the plain message in packetbuf to the aggregate being built
+// returns 0 if it is not plain data or does not fit
+int aggregate_add(void);
+// number of messages collected so far
+uint8_t aggregate_count(void);
+// replaces packetbuf with the collected messages as one multihop packet
+// originated here, behind hdr, and starts a new aggregate
+void aggregate_to_packetbuf(const struct data_header* hdr);
+// points the reader at the records of the aggregate in packetbuf
+void aggregate_reader_init(struct aggregate_reader* r);
+// reads the next record, returns 0 at the end or on a truncated record
+// payload points into packetbuf
+int aggregate_reader_next(struct aggregate_reader* r, linkaddr_t* originator,
+  struct data_header* hdr, const uint8_t** payload, uint8_t* len);
+
+#endif /* AGGREGATE_H_ */
@@ -0,0 +1,93 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "lib/random.h"
+#include "attack.h"
+
+#include <stdio.h>
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* GLOBAL VARIABLES */
+// behaviour this node runs
+static enum attack_type attack = ATTACK_NONE;
+// names indexed by attack type
+static const char* const attack_names[ATTACK_COUNT] = {
+  "none", "flooding", "blackhole", "grayhole", "selective forwarding",
+  "on-off", "bad-mouthing", "ballot-stuffing", "sybil"
+};
+// real address while a fake one is in use
+static linkaddr_t real_addr;
+// index of the next fake address
+static uint8_t sybil_index;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+void attack_init(enum attack_type type)
+{
+  attack = type < ATTACK_COUNT ? type : ATTACK_NONE;
+  if(attack != ATTACK_NONE)
+    printf("ATTACK %s started at %lu s\n", attack_names[attack], clock_seconds());
+}
+
+const char* attack_name(void)
+{
+  return attack_names[attack];
+}
+
+int attack_phase_on(void)
+{
+  if(attack != ATTACK_ON_OFF)
+    return 1;
+  return (clock_seconds() / ATTACK_ON_OFF_PERIOD) % 2 == 0;
+}
+
+int attack_drop_forward(const linkaddr_t* originator)
+{
+  switch(attack)
+  {
+  case ATTACK_BLACKHOLE:
+    return 1;
+  case ATTACK_GRAYHOLE:
+    return random_rand() % 100 < ATTACK_GRAYHOLE_DROP;
+  case ATTACK_SELECTIVE_FORWARDING:
+    return originator->u8[0] == ATTACK_VICTIM_ID && originator->u8[1] == 0;
+  case ATTACK_ON_OFF:
+    return attack_phase_on();
+  default:
+    return 0;
+  }
+}
+
+int attack_advertised_trust(const linkaddr_t* addr, int trust)
+{
+  switch(attack)
+  {
+  case ATTACK_BAD_MOUTHING:
+    return ATTACK_BAD_MOUTH_TRUST;
+  case ATTACK_BALLOT_STUFFING:
+    return ATTACK_BALLOT_TRUST;
+  default:
+    return trust;
+  }
+}
+
+void attack_spoof_begin(void)
+{
+  linkaddr_t fake;
+  if(attack != ATTACK_SYBIL)
+    return;
+  linkaddr_copy(&real_addr, &linkaddr_node_addr);
+  fake.u8[0] = ATTACK_SYBIL_BASE + sybil_index;
+  fake.u8[1] = 0;
+  sybil_index = (sybil_index + 1) % ATTACK_SYBIL_IDENTITIES;
+  // broadcast_send stamps the sender address synchronously, so swapping
+  // the node address around it is enough to forge the frame source
+  linkaddr_copy(&linkaddr_node_addr, &fake);
+}
+
+void attack_spoof_end(void)
+{
+  if(attack != ATTACK_SYBIL)
+    return;
+  linkaddr_copy(&linkaddr_node_addr, &real_addr);
+}
@@ -0,0 +1,71 @@
+#ifndef ATTACK_H_
+#define ATTACK_H_
+
+#include "net/rime/rime.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// percentage of relayed packets a grayhole drops
+#ifndef ATTACK_GRAYHOLE_DROP
+#define ATTACK_GRAYHOLE_DROP 50
+#endif
+// node whose packets are dropped by selective forwarding
+#ifndef ATTACK_VICTIM_ID
+#define ATTACK_VICTIM_ID 2
+#endif
+// length in seconds of each on and off phase
+#ifndef ATTACK_ON_OFF_PERIOD
+#define ATTACK_ON_OFF_PERIOD 30
+#endif
+// trust advertised for every neighbor when bad-mouthing
+// (0 terminates the trust vector, so 1 is the lowest usable value)
+#define ATTACK_BAD_MOUTH_TRUST 1
+// trust advertised for every neighbor when ballot-stuffing
+#define ATTACK_BALLOT_TRUST 100
+// first fake address used by the sybil attack and how many it rotates through
+#define ATTACK_SYBIL_BASE 100
+#define ATTACK_SYBIL_IDENTITIES 4
+
+/* ENUMS */
+// attacker behaviours a node can run
+enum attack_type
+{
+  ATTACK_NONE,
+  // sends multihop messages faster than MINIMUM_DELAY
+  ATTACK_FLOODING,
+  // drops every relayed packet
+  ATTACK_BLACKHOLE,
+  // drops ATTACK_GRAYHOLE_DROP percent of relayed packets
+  ATTACK_GRAYHOLE,
+  // drops relayed packets originated by ATTACK_VICTIM_ID
+  ATTACK_SELECTIVE_FORWARDING,
+  // floods and drops during the on phase, honest during the off phase
+  ATTACK_ON_OFF,
+  // advertises low trust for every neighbor
+  ATTACK_BAD_MOUTHING,
+  // advertises full trust for every neighbor
+  ATTACK_BALLOT_STUFFING,
+  // sends trust broadcasts from rotating fake addresses
+  ATTACK_SYBIL,
+  ATTACK_COUNT
+};
+
+/* FUNCTIONS */
+// selects the behaviour and logs the start of the attack
+void attack_init(enum attack_type type);
+// name of the running behaviour
+const char* attack_name(void);
+// returns 0 while an on-off attacker is in its honest phase, 1 otherwise
+int attack_phase_on(void);
+// returns 1 if a packet from originator should be dropped instead of relayed
+int attack_drop_forward(const linkaddr_t* originator);
+// trust value to advertise for a neighbor instead of the real one
+int attack_advertised_trust(const linkaddr_t* addr, int trust);
+// switches to the next fake address around a trust broadcast
+void attack_spoof_begin(void);
+// restores the real address
+void attack_spoof_end(void);
+
+#endif /* ATTACK_H_ */
@@ -0,0 +1,245 @@
+// host benchmark of the neighbor table kernels of Trust_node.c
+// the firmware is compiled in as is, against the stand-ins in host/, so
+// changes to its data structures are timed without Cooja
+//
+// usage: bench-trust [baseline]
+// prints "BENCH <kernel> <table size> <median ns/op> <min ns/op>" lines;
+// given the output of an earlier run, also compares the medians against it
+// and exits with 1 if any kernel got more than TOLERANCE percent slower
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// the firmware's printfs are compiled out, so that the timings are of the
+// table kernels and not of formatting
+#define printf(...) ((void)0)
+#include "../Trust_node.c"
+#undef printf
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// smallest and largest table size, doubled in between
+#define MIN_SIZE 16
+#define MAX_SIZE MAX_NEIGHBORS
+// timed batches per kernel and size, the median is reported
+#define REPEATS 9
+// a batch is grown until it takes at least this long
+#define MIN_BATCH_NS 2000000ULL
+// slowdown in percent against the baseline that counts as a regression
+#define TOLERANCE 10
+// addresses looked up, drawn from the table
+#define QUERIES 256
+
+/* STRUCTS */
+// a timed kernel, runs iterations operations
+struct kernel
+{
+  const char* name;
+  void (* run)(unsigned long iterations);
+};
+
+/* UTILITY FUNCTIONS */
+static uint64_t now_ns(void);
+// empties the table and adds size neighbors
+static void fill_table(int size);
+// puts a trust vector about the table into packetbuf
+static void fill_vector(int size);
+// median and minimum ns per operation of REPEATS batches
+static void time_kernel(const struct kernel* k, double* median, double* min);
+static int compare_double(const void* a, const void* b);
+// returns the baseline median of kernel at size, or 0 if there is none
+static double baseline_median(FILE* f, const char* kernel, int size);
+static void run_lookup(unsigned long iterations);
+static void run_merge(unsigned long iterations);
+static void run_blocked(unsigned long iterations);
+static void run_next_hop(unsigned long iterations);
+
+/* GLOBAL VARIABLES */
+static const struct kernel kernels[] = {
+  {"lookup", run_lookup},
+  {"merge", run_merge},
+  {"blocked", run_blocked},
+  {"next_hop", run_next_hop},
+};
+static linkaddr_t queries[QUERIES];
+// packetbuf contents update_table() merges, restored before every run
+static uint8_t vector[PACKETBUF_SIZE];
+static uint16_t vector_len;
+// keeps the compiler from dropping the kernels' results
+static volatile uintptr_t sink;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+int main(int argc, char** argv)
+{
+  FILE* baseline = NULL;
+  double median, min, old;
+  int regressions = 0;
+  unsigned k;
+  int size;
+
+  if(argc > 1 && (baseline = fopen(argv[1], "r")) == NULL)
+  {
+    perror(argv[1]);
+    return 2;
+  }
+  memb_init(&neighbor_mem);
+  list_init(neighbor_table);
+  for(size = MIN_SIZE; size <= MAX_SIZE; size *= 2)
+  {
+    fill_table(size);
+    fill_vector(size);
+    for(k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++)
+    {
+      time_kernel(&kernels[k], &median, &min);
+      printf("BENCH %s %d %.1f %.1f", kernels[k].name, size, median, min);
+      old = baseline != NULL ? baseline_median(baseline, kernels[k].name, size) : 0;
+      if(old > 0)
+      {
+        printf(" was %.1f (%+.1f%%)", old, (median - old) * 100 / old);
+        if(median > old * (100 + TOLERANCE) / 100)
+        {
+          printf(" REGRESSION");
+          regressions++;
+        }
+      }
+      printf("\n");
+    }
+  }
+  if(baseline != NULL)
+    fclose(baseline);
+  return regressions > 0;
+}
+
+static uint64_t now_ns(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+static void fill_table(int size)
+{
+  struct neighbor* n;
+  linkaddr_t a;
+  int i;
+
+  while((n = list_pop(neighbor_table)) != NULL)
+    memb_free(&neighbor_mem, n);
+  for(i = 0; i < size; i++)
+  {
+    // clear of 0.0 and of the sink at 1.0
+    a.u8[0] = (i + 2) & 0xff;
+    a.u8[1] = (i + 2) >> 8;
+    n = add_neighbor(&a);
+    n->trust = 60 + random_rand() % 41;
+  }
+  for(i = 0; i < QUERIES; i++)
+  {
+    a.u8[0] = (random_rand() % size + 2) & 0xff;
+    a.u8[1] = (random_rand() % size + 2) >> 8;
+    queries[i] = a;
+  }
+}
+
+static void fill_vector(int size)
+{
+  struct neighbor_trust nt;
+  int i, count;
+
+  // as many records as a broadcast carries, each about a table entry
+  count = PACKETBUF_SIZE / sizeof(nt);
+  if(count > size)
+    count = size;
+  for(i = 0; i < count; i++)
+  {
+    nt.addr = queries[i % QUERIES];
+    nt.trust = 60 + random_rand() % 41;
+    memcpy(vector + i * sizeof(nt), &nt, sizeof(nt));
+  }
+  vector_len = count * sizeof(nt);
+}
+
+static void time_kernel(const struct kernel* k, double* median, double* min)
+{
+  double samples[REPEATS];
+  unsigned long iterations = 1;
+  uint64_t start, elapsed;
+  int i;
+
+  // warms the caches and sizes the batch
+  for(;;)
+  {
+    start = now_ns();
+    k->run(iterations);
+    elapsed = now_ns() - start;
+    if(elapsed >= MIN_BATCH_NS)
+      break;
+    iterations *= 2;
+  }
+  for(i = 0; i < REPEATS; i++)
+  {
+    start = now_ns();
+    k->run(iterations);
+    samples[i] = (double)(now_ns() - start) / iterations;
+  }
+  qsort(samples, REPEATS, sizeof(samples[0]), compare_double);
+  *median = samples[REPEATS / 2];
+  *min = samples[0];
+}
+
+static int compare_double(const void* a, const void* b)
+{
+  double x = *(const double*)a, y = *(const double*)b;
+  return (x > y) - (x < y);
+}
+
+static double baseline_median(FILE* f, const char* kernel, int size)
+{
+  char line[160], name[32];
+  int s;
+  double median;
+
+  rewind(f);
+  while(fgets(line, sizeof(line), f) != NULL)
+  {
+    if(sscanf(line, "BENCH %31s %d %lf", name, &s, &median) == 3
+       && s == size && strcmp(name, kernel) == 0)
+      return median;
+  }
+  return 0;
+}
+
+static void run_lookup(unsigned long iterations)
+{
+  unsigned long i;
+  for(i = 0; i < iterations; i++)
+    sink += (uintptr_t)find_neighbor(&queries[i % QUERIES]);
+}
+
+static void run_merge(unsigned long iterations)
+{
+  unsigned long i;
+  for(i = 0; i < iterations; i++)
+  {
+    packetbuf_copyfrom(vector, vector_len);
+    update_table();
+  }
+  sink += ((struct neighbor*)list_head(neighbor_table))->trust;
+}
+
+static void run_blocked(unsigned long iterations)
+{
+  unsigned long i;
+  for(i = 0; i < iterations; i++)
+    sink += addr_is_blocked(&queries[i % QUERIES]);
+}
+
+static void run_next_hop(unsigned long iterations)
+{
+  unsigned long i;
+  for(i = 0; i < iterations; i++)
+    sink += (uintptr_t)choose_next_hop(NULL, 0);
+}
@@ -0,0 +1,55 @@
+// host stand-in for Contiki's contiki.h, declares only what the benchmark uses
+#ifndef CONTIKI_H
+#define CONTIKI_H
+#include <stdint.h>
+#include <string.h>
+typedef unsigned short clock_time_t;
+#define CLOCK_SECOND 128
+clock_time_t clock_time(void);
+unsigned long clock_seconds(void);
+struct process; int process_is_running(struct process *p);
+typedef unsigned char process_event_t;
+typedef void * process_data_t;
+struct pt { unsigned short lc; };
+struct process { struct process *next; const char *name; char (*thread)(struct pt *, process_event_t, process_data_t); struct pt pt; };
+#define PROCESS(name, strname) static char process_thread_##name(struct pt *process_pt, process_event_t ev, process_data_t data); struct process name = { NULL, strname, process_thread_##name }
+#define PROCESS_NAME(name) extern struct process name
+#define PROCESS_THREAD(name, ev, data) static char process_thread_##name(struct pt *process_pt, process_event_t ev, process_data_t data)
+#define AUTOSTART_PROCESSES(...) struct process * const autostart_processes[] = {__VA_ARGS__, NULL}
+#define PROCESS_BEGIN() switch(process_pt->lc) { case 0:
+#define PROCESS_END() } return 3
+#define PROCESS_EXITHANDLER(handler) if(ev == 0x83) { handler; }
+#define PROCESS_WAIT_EVENT_UNTIL(c) do { process_pt->lc = __LINE__; case __LINE__: if(!(c)) return 1; } while(0)
+#define PROCESS_WAIT_EVENT() PROCESS_WAIT_EVENT_UNTIL(1)
+#define PROCESS_YIELD() PROCESS_WAIT_EVENT_UNTIL(1)
+#define PROCESS_PAUSE() PROCESS_WAIT_EVENT_UNTIL(1)
+#define PROCESS_CURRENT() process_current
+extern struct process *process_current;
+void process_start(struct process *p, process_data_t data);
+int process_post(struct process *p, process_event_t ev, process_data_t data);
+void process_poll(struct process *p);
+process_event_t process_alloc_event(void);
+#define PROCESS_EVENT_POLL 0x82
+#define PROCESS_EVENT_TIMER 0x88
+#define PROCESS_BROADCAST NULL
+struct timer { clock_time_t start, interval; };
+struct etimer { struct timer timer; struct etimer *next; struct process *p; };
+void etimer_set(struct etimer *et, clock_time_t interval);
+void etimer_reset(struct etimer *et);
+void etimer_restart(struct etimer *et);
+int etimer_expired(struct etimer *et);
+void etimer_stop(struct etimer *et);
+struct ctimer { struct ctimer *next; struct etimer etimer; struct process *p; void (*f)(void *); void *ptr; };
+void ctimer_set(struct ctimer *c, clock_time_t t, void (*f)(void *), void *ptr);
+void ctimer_stop(struct ctimer *c);
+void ctimer_reset(struct ctimer *c);
+int ctimer_expired(struct ctimer *c);
+typedef unsigned short rtimer_clock_t;
+#define RTIMER_SECOND 4096
+rtimer_clock_t rtimer_arch_now(void);
+#define RTIMER_NOW() rtimer_arch_now()
+#define RTIMER_CLOCK_DIFF(a,b) ((signed short)((a)-(b)))
+#define CC_INLINE inline
+#define MIN(a, b) ((a) < (b)? (a) : (b))
+#define MAX(a, b) ((a) > (b)? (a) : (b))
+#endif
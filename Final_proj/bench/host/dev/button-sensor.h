@@ -0,0 +1,6 @@
+// host stand-in for Contiki's dev/button-sensor.h, declares only what the benchmark uses
+#ifndef STUB_BUTTON
+#define STUB_BUTTON
+#include "lib/sensors.h"
+extern const struct sensors_sensor button_sensor;
+#endif
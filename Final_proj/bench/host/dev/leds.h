@@ -0,0 +1,8 @@
+// host stand-in for Contiki's dev/leds.h, declares only what the benchmark uses
+#ifndef STUB__DEV_LEDS_H
+#define STUB__DEV_LEDS_H
+#define LEDS_RED 4
+#define LEDS_GREEN 2
+#define LEDS_BLUE 1
+void leds_on(unsigned char l); void leds_off(unsigned char l); void leds_toggle(unsigned char l);
+#endif
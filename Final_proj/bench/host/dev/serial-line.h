@@ -0,0 +1,7 @@
+// host stand-in for Contiki's dev/serial-line.h, declares only what the benchmark uses
+#ifndef STUB__DEV_SERIAL_LINE_H
+#define STUB__DEV_SERIAL_LINE_H
+#include "contiki.h"
+extern process_event_t serial_line_event_message;
+void serial_line_init(void);
+#endif
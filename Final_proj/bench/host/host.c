@@ -0,0 +1,271 @@
+// host stand-ins for the parts of Contiki and of the firmware modules that
+// Trust_node.c links against
+// list, memb, packetbuf and random behave like Contiki's, since the timed
+// kernels run on them; the rest does nothing
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "net/llsec/anti-replay.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+#include "lib/random.h"
+#include "sys/node-id.h"
+#include "dev/serial-line.h"
+#include "../../attack.h"
+#include "../../trust-auth.h"
+#include "../../link-sec.h"
+#include "../../fwd-queue.h"
+#include "../../journal.h"
+#include "../../link-filter.h"
+#include "../../sink-stats.h"
+#include "../../trust-store.h"
+#include "../../stack-mark.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* STRUCTS */
+// list_t points at the head pointer, every item starts with its next
+struct list
+{
+  struct list* next;
+};
+
+/* GLOBAL VARIABLES */
+linkaddr_t linkaddr_node_addr;
+unsigned short node_id;
+process_event_t serial_line_event_message;
+static uint8_t packetbuf[PACKETBUF_SIZE];
+static uint16_t packetbuf_len;
+static packetbuf_attr_t attrs[PACKETBUF_ADDR_SENDER];
+static linkaddr_t addrs[PACKETBUF_ADDR_ERECEIVER - PACKETBUF_ADDR_SENDER + 1];
+static unsigned short seed = 1;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+/* CONTIKI */
+
+int linkaddr_cmp(const linkaddr_t* a, const linkaddr_t* b)
+{
+  return a->u16 == b->u16;
+}
+
+void linkaddr_copy(linkaddr_t* d, const linkaddr_t* s)
+{
+  *d = *s;
+}
+
+void list_init(list_t list)
+{
+  *list = NULL;
+}
+
+void* list_head(list_t list)
+{
+  return *list;
+}
+
+void list_add(list_t list, void* item)
+{
+  struct list** l = (struct list**)list;
+  ((struct list*)item)->next = NULL;
+  while(*l != NULL)
+    l = &(*l)->next;
+  *l = item;
+}
+
+void* list_pop(list_t list)
+{
+  struct list* l = *list;
+  if(l != NULL)
+    *list = l->next;
+  return l;
+}
+
+void list_remove(list_t list, void* item)
+{
+  struct list** l = (struct list**)list;
+  while(*l != NULL && *l != item)
+    l = &(*l)->next;
+  if(*l != NULL)
+    *l = (*l)->next;
+}
+
+int list_length(list_t list)
+{
+  struct list* l;
+  int n = 0;
+  for(l = *list; l != NULL; l = l->next)
+    n++;
+  return n;
+}
+
+void memb_init(struct memb* m)
+{
+  memset(m->count, 0, m->num);
+}
+
+void* memb_alloc(struct memb* m)
+{
+  int i;
+  for(i = 0; i < m->num; i++)
+  {
+    if(m->count[i] == 0)
+    {
+      m->count[i] = 1;
+      return (char*)m->mem + i * m->size;
+    }
+  }
+  return NULL;
+}
+
+char memb_free(struct memb* m, void* ptr)
+{
+  m->count[((char*)ptr - (char*)m->mem) / m->size] = 0;
+  return 0;
+}
+
+unsigned short random_rand(void)
+{
+  // fixed seed, so every run times the same choices
+  seed = seed * 25173 + 13849;
+  return seed;
+}
+
+int packetbuf_copyfrom(const void* from, uint16_t len)
+{
+  packetbuf_len = len < PACKETBUF_SIZE ? len : PACKETBUF_SIZE;
+  memcpy(packetbuf, from, packetbuf_len);
+  return packetbuf_len;
+}
+
+void* packetbuf_dataptr(void)
+{
+  return packetbuf;
+}
+
+uint16_t packetbuf_datalen(void)
+{
+  return packetbuf_len;
+}
+
+uint16_t packetbuf_totlen(void)
+{
+  return packetbuf_len;
+}
+
+void packetbuf_set_datalen(uint16_t len)
+{
+  packetbuf_len = len;
+}
+
+void packetbuf_clear(void)
+{
+  packetbuf_len = 0;
+  memset(attrs, 0, sizeof(attrs));
+}
+
+int packetbuf_set_attr(uint8_t type, const packetbuf_attr_t val)
+{
+  attrs[type] = val;
+  return 1;
+}
+
+packetbuf_attr_t packetbuf_attr(uint8_t type)
+{
+  return attrs[type];
+}
+
+int packetbuf_set_addr(uint8_t type, const linkaddr_t* addr)
+{
+  addrs[type - PACKETBUF_ADDR_SENDER] = *addr;
+  return 1;
+}
+
+const linkaddr_t* packetbuf_addr(uint8_t type)
+{
+  return &addrs[type - PACKETBUF_ADDR_SENDER];
+}
+
+clock_time_t clock_time(void) { return 0; }
+unsigned long clock_seconds(void) { return 0; }
+void ctimer_set(struct ctimer* c, clock_time_t t, void (*f)(void*), void* ptr) {}
+void etimer_set(struct etimer* et, clock_time_t interval) {}
+int etimer_expired(struct etimer* et) { return 0; }
+void anti_replay_init_info(struct anti_replay_info* info) {}
+void broadcast_open(struct broadcast_conn* c, uint16_t channel,
+  const struct broadcast_callbacks* u) {}
+void broadcast_close(struct broadcast_conn* c) {}
+int broadcast_send(struct broadcast_conn* c) { return 1; }
+void multihop_open(struct multihop_conn* c, uint16_t channel,
+  const struct multihop_callbacks* u) {}
+void multihop_close(struct multihop_conn* c) {}
+int multihop_send(struct multihop_conn* c, const linkaddr_t* to) { return 1; }
+void multihop_resend(struct multihop_conn* c, const linkaddr_t* nexthop) {}
+void neighbor_discovery_open(struct neighbor_discovery_conn* c,
+  uint16_t channel, clock_time_t initial, clock_time_t min, clock_time_t max,
+  const struct neighbor_discovery_callbacks* u) {}
+void neighbor_discovery_close(struct neighbor_discovery_conn* c) {}
+void neighbor_discovery_start(struct neighbor_discovery_conn* c,
+  uint16_t val) {}
+
+/* FIRMWARE MODULES */
+
+void attack_init(enum attack_type type) {}
+int attack_phase_on(void) { return 0; }
+int attack_drop_forward(const linkaddr_t* originator) { return 0; }
+int attack_advertised_trust(const linkaddr_t* addr, int trust) { return trust; }
+void attack_spoof_begin(void) {}
+void attack_spoof_end(void) {}
+int trust_auth_seal(void) { return 1; }
+int trust_auth_verify(const linkaddr_t* from) { return 1; }
+int trust_auth_replayed(struct anti_replay_info* info) { return 0; }
+void trust_auth_resume(uint32_t ceiling) {}
+uint32_t trust_auth_reserve(void) { return 0; }
+void link_sec_init(void) {}
+void link_sec_clear(struct link_key* k) {}
+int link_sec_derive(struct link_key* k, const linkaddr_t* peer)
+{
+  k->valid = 1;
+  return 1;
+}
+void link_sec_revoke(struct link_key* k) {}
+int link_sec_replayed(struct anti_replay_info* info) { return 0; }
+int link_sec_seal(const struct link_key* k, const linkaddr_t* receiver)
+{
+  return 1;
+}
+int link_sec_verify(const struct link_key* k, const linkaddr_t* sender,
+  uint8_t hops)
+{
+  return 1;
+}
+void fwd_queue_init(fwd_queue_send_t send) {}
+int fwd_queue_enqueue(const linkaddr_t* nexthop, int trust) { return 0; }
+void fwd_queue_report(void) {}
+void journal_init(void) {}
+void journal_add(enum journal_type type, const linkaddr_t* addr,
+  uint8_t value) {}
+void journal_dump(void) {}
+int link_filter_block(const linkaddr_t* addr) { return 1; }
+void link_filter_unblock(const linkaddr_t* addr) {}
+uint16_t link_filter_dropped(void) { return 0; }
+uint16_t link_filter_overflow(void) { return 0; }
+uint16_t mac_blacklist_refused(void) { return 0; }
+void sink_stats_init(void) {}
+void sink_stats_record(const linkaddr_t* origin, uint16_t seqno,
+  clock_time_t latency, uint8_t hops) {}
+void sink_stats_shed(const linkaddr_t* origin) {}
+void sink_stats_dump(void) {}
+int trust_store_load(struct trust_record* records, int max,
+  uint32_t* counter)
+{
+  *counter = 0;
+  return 0;
+}
+int trust_store_save(const struct trust_record* records, int count,
+  uint32_t counter)
+{
+  return 0;
+}
+void stack_mark_init(void) {}
+uint16_t stack_mark_used(void) { return 0; }
+uint16_t stack_mark_size(void) { return 0; }
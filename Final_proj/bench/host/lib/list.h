@@ -0,0 +1,15 @@
+// host stand-in for Contiki's lib/list.h, declares only what the benchmark uses
+#ifndef LIST_H
+#define LIST_H
+#define LIST(name) static void *name##_list = NULL; static list_t name = (list_t)&name##_list
+typedef void ** list_t;
+void list_init(list_t list); void *list_head(list_t list); void *list_tail(list_t list); void *list_pop(list_t list);
+void list_push(list_t list, void *item); void *list_chop(list_t list); void list_add(list_t list, void *item);
+void list_remove(list_t list, void *item); int list_length(list_t list); void *list_item_next(void *item);
+void list_insert(list_t list, void *previtem, void *newitem);
+#endif
+#ifndef STUB_LIST_STRUCT
+#define STUB_LIST_STRUCT
+#define LIST_STRUCT(name) void *name##_list; list_t name
+#define LIST_STRUCT_INIT(struct_ptr, name) do { (struct_ptr)->name = &((struct_ptr)->name##_list); (struct_ptr)->name##_list = NULL; list_init((struct_ptr)->name); } while(0)
+#endif
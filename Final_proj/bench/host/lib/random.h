@@ -0,0 +1,6 @@
+// host stand-in for Contiki's lib/random.h, declares only what the benchmark uses
+#ifndef RANDOM_H
+#define RANDOM_H
+void random_init(unsigned short seed); unsigned short random_rand(void);
+#define RANDOM_RAND_MAX 65535U
+#endif
@@ -0,0 +1,8 @@
+// host stand-in for Contiki's lib/sensors.h, declares only what the benchmark uses
+#ifndef STUB_SENSORS
+#define STUB_SENSORS
+#include "contiki.h"
+struct sensors_sensor { char *type; int (* value)(int type); int (* configure)(int type, int value); int (* status)(int type); };
+extern process_event_t sensors_event;
+#define SENSORS_ACTIVATE(sensor) (sensor).configure(1, 1)
+#endif
@@ -0,0 +1,7 @@
+// host stand-in for Contiki's net/llsec/anti-replay.h, declares only what the benchmark uses
+#ifndef STUB__NET_LLSEC_ANTI_REPLAY_H
+#define STUB__NET_LLSEC_ANTI_REPLAY_H
+#include <stdint.h>
+struct anti_replay_info { uint32_t last_broadcast_counter; uint32_t last_unicast_counter; };
+void anti_replay_set_counter(void); uint32_t anti_replay_get_counter(void); void anti_replay_init_info(struct anti_replay_info *info); int anti_replay_was_replayed(struct anti_replay_info *info);
+#endif
@@ -0,0 +1,14 @@
+// host stand-in for Contiki's net/netstack.h, declares only what the benchmark uses
+#ifndef STUB_NETSTACK
+#define STUB_NETSTACK
+#include "contiki.h"
+struct network_driver { char *name; void (* init)(void); void (* input)(void); };
+extern const struct network_driver rime_driver;
+typedef void (* mac_callback_t)(void *ptr, int status, int transmissions);
+struct rdc_driver { char *name; void (* init)(void); void (* send)(mac_callback_t sent_callback, void *ptr); void (* send_list)(mac_callback_t sent_callback, void *ptr, void *list); void (* input)(void); int (* on)(void); int (* off)(int keep_radio_on); unsigned short (* channel_check_interval)(void); };
+struct mac_driver { char *name; void (* init)(void); void (* send)(mac_callback_t sent_callback, void *ptr); void (* input)(void); int (* on)(void); int (* off)(int keep_radio_on); unsigned short (* channel_check_interval)(void); };
+extern const struct rdc_driver contikimac_driver;
+extern const struct mac_driver csma_driver;
+enum { MAC_TX_OK, MAC_TX_COLLISION, MAC_TX_NOACK, MAC_TX_DEFERRED, MAC_TX_ERR, MAC_TX_ERR_FATAL };
+void mac_call_sent_callback(mac_callback_t sent, void *ptr, int status, int num_tx);
+#endif
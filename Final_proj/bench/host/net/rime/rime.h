@@ -0,0 +1,91 @@
+// host stand-in for Contiki's net/rime/rime.h, declares only what the benchmark uses
+#ifndef RIME_H
+#define RIME_H
+#include "contiki.h"
+typedef union { unsigned char u8[2]; uint16_t u16; } linkaddr_t;
+extern linkaddr_t linkaddr_node_addr;
+extern const linkaddr_t linkaddr_null;
+int linkaddr_cmp(const linkaddr_t *a, const linkaddr_t *b);
+void linkaddr_copy(linkaddr_t *d, const linkaddr_t *s);
+void linkaddr_set_node_addr(linkaddr_t *a);
+#define LINKADDR_SIZE 2
+#define PACKETBUF_SIZE 128
+#define PACKETBUF_HDR_SIZE 48
+int packetbuf_copyfrom(const void *from, uint16_t len);
+int packetbuf_copyto(void *to);
+void *packetbuf_dataptr(void);
+void *packetbuf_hdrptr(void);
+uint16_t packetbuf_datalen(void);
+uint16_t packetbuf_totlen(void);
+void packetbuf_set_datalen(uint16_t len);
+void packetbuf_clear(void);
+int packetbuf_hdralloc(int size);
+int packetbuf_hdrreduce(int size);
+typedef uint16_t packetbuf_attr_t;
+enum { PACKETBUF_ATTR_NONE, PACKETBUF_ATTR_CHANNEL, PACKETBUF_ATTR_RSSI, PACKETBUF_ATTR_LINK_QUALITY, PACKETBUF_ATTR_HOPS, PACKETBUF_ATTR_EPACKET_ID, PACKETBUF_ATTR_PACKET_ID, PACKETBUF_ATTR_MAX_REXMIT, PACKETBUF_ATTR_RELIABLE, PACKETBUF_ATTR_PACKET_TYPE, PACKETBUF_ATTR_TTL, PACKETBUF_ATTR_SECURITY_LEVEL, PACKETBUF_ATTR_FRAME_COUNTER_BYTES_0_1, PACKETBUF_ATTR_FRAME_COUNTER_BYTES_2_3,
+ PACKETBUF_ADDR_SENDER, PACKETBUF_ADDR_RECEIVER, PACKETBUF_ADDR_ESENDER, PACKETBUF_ADDR_ERECEIVER };
+int packetbuf_set_attr(uint8_t type, const packetbuf_attr_t val);
+packetbuf_attr_t packetbuf_attr(uint8_t type);
+int packetbuf_set_addr(uint8_t type, const linkaddr_t *addr);
+const linkaddr_t *packetbuf_addr(uint8_t type);
+struct queuebuf;
+struct queuebuf *queuebuf_new_from_packetbuf(void);
+void queuebuf_to_packetbuf(struct queuebuf *b);
+void queuebuf_free(struct queuebuf *b);
+void *queuebuf_dataptr(struct queuebuf *b);
+int queuebuf_datalen(struct queuebuf *b);
+struct channel { struct channel *next; uint16_t channelno; };
+struct abc_conn { struct channel channel; const void *u; };
+struct broadcast_conn;
+struct broadcast_callbacks { void (* recv)(struct broadcast_conn *ptr, const linkaddr_t *sender); void (* sent)(struct broadcast_conn *ptr, int status, int num_tx); };
+struct broadcast_conn { struct abc_conn c; const struct broadcast_callbacks *u; };
+void broadcast_open(struct broadcast_conn *c, uint16_t channel, const struct broadcast_callbacks *u);
+void broadcast_close(struct broadcast_conn *c);
+int broadcast_send(struct broadcast_conn *c);
+struct unicast_conn;
+struct unicast_callbacks { void (* recv)(struct unicast_conn *c, const linkaddr_t *from); void (* sent)(struct unicast_conn *ptr, int status, int num_tx); };
+struct unicast_conn { struct broadcast_conn c; const struct unicast_callbacks *u; };
+void unicast_open(struct unicast_conn *c, uint16_t channel, const struct unicast_callbacks *u);
+void unicast_close(struct unicast_conn *c);
+int unicast_send(struct unicast_conn *c, const linkaddr_t *receiver);
+struct multihop_conn;
+struct multihop_callbacks {
+  void (* recv)(struct multihop_conn *ptr, const linkaddr_t *sender, const linkaddr_t *prevhop, uint8_t hops);
+  linkaddr_t *(* forward)(struct multihop_conn *ptr, const linkaddr_t *originator, const linkaddr_t *dest, const linkaddr_t *prevhop, uint8_t hops);
+};
+struct multihop_conn { struct unicast_conn c; const struct multihop_callbacks *cb; };
+void multihop_open(struct multihop_conn *c, uint16_t channel, const struct multihop_callbacks *u);
+void multihop_close(struct multihop_conn *c);
+int multihop_send(struct multihop_conn *c, const linkaddr_t *to);
+void multihop_resend(struct multihop_conn *c, const linkaddr_t *nexthop);
+struct runicast_conn;
+struct runicast_callbacks { void (* recv)(struct runicast_conn *c, const linkaddr_t *from, uint8_t seqno); void (* sent)(struct runicast_conn *c, const linkaddr_t *to, uint8_t retransmissions); void (* timedout)(struct runicast_conn *c, const linkaddr_t *to, uint8_t retransmissions); };
+struct runicast_conn { struct unicast_conn c; const struct runicast_callbacks *u; uint8_t sndnxt; uint8_t is_tx; uint8_t rxmit; uint8_t max_rxmit; };
+void runicast_open(struct runicast_conn *c, uint16_t channel, const struct runicast_callbacks *u);
+void runicast_close(struct runicast_conn *c);
+int runicast_send(struct runicast_conn *c, const linkaddr_t *receiver, uint8_t max_retransmissions);
+uint8_t runicast_is_transmitting(struct runicast_conn *c);
+struct netflood_conn;
+struct netflood_callbacks { int (* recv)(struct netflood_conn *c, const linkaddr_t *from, const linkaddr_t *originator, uint8_t seqno, uint8_t hops); void (* sent)(struct netflood_conn *c); void (* dropped)(struct netflood_conn *c); };
+struct netflood_conn { struct broadcast_conn c; const struct netflood_callbacks *u; clock_time_t queue_time; linkaddr_t last_originator; uint8_t last_originator_seqno; };
+void netflood_open(struct netflood_conn *c, clock_time_t queue_time, uint16_t channel, const struct netflood_callbacks *u);
+void netflood_close(struct netflood_conn *c);
+int netflood_send(struct netflood_conn *c, uint8_t seqno);
+struct broadcast_announcement_dummy;
+void broadcast_announcement_init(uint16_t channel, clock_time_t min, clock_time_t initial, clock_time_t max);
+struct announcement;
+typedef void (*announcement_callback_t)(struct announcement *a, const linkaddr_t *from, uint16_t id, uint16_t val);
+struct announcement { struct announcement *next; uint16_t id; uint16_t value; announcement_callback_t callback; uint8_t has_value; };
+void announcement_register(struct announcement *a, uint16_t id, announcement_callback_t callback);
+void announcement_remove(struct announcement *a);
+void announcement_set_value(struct announcement *a, uint16_t value);
+void announcement_bump(struct announcement *a);
+void announcement_listen(int periods);
+struct neighbor_discovery_conn;
+struct neighbor_discovery_callbacks { void (* recv)(struct neighbor_discovery_conn *c, const linkaddr_t *from, uint16_t val); void (* sent)(struct neighbor_discovery_conn *c); };
+struct neighbor_discovery_conn { struct broadcast_conn c; const struct neighbor_discovery_callbacks *u; struct ctimer send_timer, interval_timer; clock_time_t initial_interval, min_interval, max_interval; uint16_t val; };
+void neighbor_discovery_open(struct neighbor_discovery_conn *c, uint16_t channel, clock_time_t initial, clock_time_t min, clock_time_t max, const struct neighbor_discovery_callbacks *u);
+void neighbor_discovery_close(struct neighbor_discovery_conn *c);
+void neighbor_discovery_set_val(struct neighbor_discovery_conn *c, uint16_t val);
+void neighbor_discovery_start(struct neighbor_discovery_conn *c, uint16_t val);
+#endif
@@ -0,0 +1,5 @@
+// host stand-in for Contiki's sys/node-id.h, declares only what the benchmark uses
+#ifndef STUB__SYS_NODE_ID_H
+#define STUB__SYS_NODE_ID_H
+extern unsigned short node_id;
+#endif
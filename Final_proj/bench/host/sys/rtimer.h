@@ -0,0 +1,5 @@
+// host stand-in for Contiki's sys/rtimer.h, declares only what the benchmark uses
+#ifndef STUB_RTIMER_H
+#define STUB_RTIMER_H
+#include "contiki.h"
+#endif
@@ -0,0 +1,397 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "blocklist.h"
+#include "trust-auth.h"
+#include "link-filter.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// bytes of the version in front of the entries
+#define VERSION_LEN 2
+// bytes of one entry, an address followed by its distance
+#define ENTRY_LEN (LINKADDR_SIZE + 1)
+// distance() of an address that is not blocked
+#define NO_VERDICT 0xff
+
+/* STRUCTS */
+// the latest list of one originator; the node's own slot only holds the
+// addresses it isolated itself, its verdicts are added when it is sent
+struct origin
+{
+  linkaddr_t addr;
+  uint16_t version;
+  // clock_seconds() when the list was last heard
+  unsigned long heard;
+  uint8_t count;
+  linkaddr_t accused[BLOCKLIST_MAX_ACCUSED];
+  // 0 where the originator isolated the address itself, otherwise the
+  // distance of the verdict it relays
+  uint8_t dist[BLOCKLIST_MAX_ACCUSED];
+};
+
+/* UTILITY FUNCTIONS */
+// returns the list of an originator, allocating an empty one if needed
+// when the table is full, the oldest list of an untrusted originator is
+// reused; returns NULL if there is none
+static struct origin* lookup(const linkaddr_t* addr);
+// returns 1 if the list of o counts towards the quorum
+static int counts(const struct origin* o);
+// number of counting lists carrying addr
+static uint8_t votes(const linkaddr_t* addr);
+// distance of the verdict on addr: one more than the largest of the
+// BLOCKLIST_QUORUM shortest distances counting lists give it, or
+// NO_VERDICT if there are fewer or it exceeds BLOCKLIST_MAX_DISTANCE
+static uint8_t distance(const linkaddr_t* addr);
+// returns 1 if addr is in the first count entries of list
+static int listed(const linkaddr_t* list, uint8_t count, const linkaddr_t* addr);
+// copies the accused addresses and their distances into o, leaving out
+// the sink; dist NULL stands for the node's own isolations
+static void update(struct origin* o, const linkaddr_t* accused,
+  const uint8_t* dist, uint8_t count);
+// drops expired lists and floods the node's own one again
+static void refresh(void* ptr);
+// writes the node's own isolations and verdicts to packetbuf and floods them
+static void send_own(void* ptr);
+// called by netflood for every new flood, returns 1 to relay it
+static int recv(struct netflood_conn* c, const linkaddr_t* from,
+  const linkaddr_t* originator, uint8_t seqno, uint8_t hops);
+// makes netflood forget the last originator it saw
+static void forget_last(void* ptr);
+
+/* GLOBAL VARIABLES */
+static struct origin origins[BLOCKLIST_MAX_ORIGINS];
+// number of origins in use
+static uint8_t num_origins;
+// addresses currently blocked network-wide and the distance of each verdict
+static linkaddr_t blocked[BLOCKLIST_MAX_BLOCKED];
+static uint8_t blocked_dist[BLOCKLIST_MAX_BLOCKED];
+static uint8_t num_blocked;
+// version of the node's own list
+static uint16_t own_version;
+static const struct blocklist_callbacks* cb;
+static const linkaddr_t* sink_addr;
+static struct ctimer refresh_timer;
+static struct ctimer forget_timer;
+// runs send_own() once the event that changed the list has returned
+static struct ctimer send_timer;
+static const struct netflood_callbacks flood_call = {recv, NULL, NULL};
+static struct netflood_conn flood;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+void blocklist_open(const struct blocklist_callbacks* callbacks,
+  const linkaddr_t* sink)
+{
+  cb = callbacks;
+  sink_addr = sink;
+  netflood_open(&flood, BLOCKLIST_QUEUE_TIME, BLOCKLIST_CHANNEL, &flood_call);
+  ctimer_set(&refresh_timer, BLOCKLIST_REFRESH, refresh, NULL);
+}
+
+void blocklist_publish(const linkaddr_t* accused, uint8_t count)
+{
+  struct origin* o = lookup(&linkaddr_node_addr);
+  if(o == NULL)
+    return;
+  if(count > BLOCKLIST_MAX_ACCUSED)
+    count = BLOCKLIST_MAX_ACCUSED;
+  o->heard = clock_seconds();
+  update(o, accused, NULL, count);
+  blocklist_reevaluate();
+  // isolations happen while a received frame is being handled, which
+  // still needs packetbuf, so the list is flooded afterwards
+  ctimer_set(&send_timer, 0, send_own, NULL);
+}
+
+int blocklist_is_blocked(const linkaddr_t* addr)
+{
+  return listed(blocked, num_blocked, addr);
+}
+
+void blocklist_reevaluate(void)
+{
+  struct origin* o;
+  linkaddr_t addr;
+  uint8_t i = 0;
+  uint8_t d;
+  uint8_t changed = 0;
+
+  // released first, which may make room for new verdicts
+  while(i < num_blocked)
+  {
+    d = distance(&blocked[i]);
+    if(d != NO_VERDICT)
+    {
+      changed |= d != blocked_dist[i];
+      blocked_dist[i++] = d;
+      continue;
+    }
+    addr = blocked[i];
+    num_blocked--;
+    blocked[i] = blocked[num_blocked];
+    blocked_dist[i] = blocked_dist[num_blocked];
+    changed = 1;
+    cb->changed(&addr, 0);
+  }
+  for(o = origins; o < origins + num_origins; o++)
+  {
+    for(i = 0; i < o->count; i++)
+    {
+      // a node accused by others still talks to itself
+      if(linkaddr_cmp(&o->accused[i], &linkaddr_node_addr)
+         || listed(blocked, num_blocked, &o->accused[i]))
+        continue;
+      d = distance(&o->accused[i]);
+      if(d == NO_VERDICT)
+        continue;
+      if(num_blocked == BLOCKLIST_MAX_BLOCKED)
+      {
+        printf("blocklist full, %d.%d not blocked\n", o->accused[i].u8[0],
+          o->accused[i].u8[1]);
+        continue;
+      }
+      linkaddr_copy(&blocked[num_blocked], &o->accused[i]);
+      blocked_dist[num_blocked++] = d;
+      changed = 1;
+      cb->changed(&o->accused[i], 1);
+    }
+  }
+  // the verdicts go out with the own list, for the neighbors to count
+  if(changed)
+    ctimer_set(&send_timer, 0, send_own, NULL);
+}
+
+void blocklist_report(void)
+{
+  struct origin* o;
+  uint8_t i;
+  for(o = origins; o < origins + num_origins; o++)
+  {
+    printf("B %d.%d v%u%s", o->addr.u8[0], o->addr.u8[1], o->version,
+      counts(o) ? "" : " untrusted");
+    for(i = 0; i < o->count; i++)
+      printf(" %d.%d/d%u/%u%s", o->accused[i].u8[0], o->accused[i].u8[1],
+        o->dist[i], votes(&o->accused[i]),
+        blocklist_is_blocked(&o->accused[i]) ? "!" : "");
+    printf("\n");
+  }
+}
+
+static struct origin* lookup(const linkaddr_t* addr)
+{
+  struct origin* o;
+  struct origin* oldest = NULL;
+  for(o = origins; o < origins + num_origins; o++)
+  {
+    if(linkaddr_cmp(&o->addr, addr))
+      return o;
+    if(!counts(o) && (oldest == NULL || o->heard < oldest->heard))
+      oldest = o;
+  }
+  if(num_origins < BLOCKLIST_MAX_ORIGINS)
+    o = &origins[num_origins++];
+  else if(oldest != NULL)
+    o = oldest;
+  else
+    return NULL;
+  linkaddr_copy(&o->addr, addr);
+  o->version = 0;
+  o->heard = 0;
+  o->count = 0;
+  return o;
+}
+
+static int counts(const struct origin* o)
+{
+  return linkaddr_cmp(&o->addr, &linkaddr_node_addr) || cb->trusted(&o->addr);
+}
+
+static uint8_t votes(const linkaddr_t* addr)
+{
+  struct origin* o;
+  uint8_t n = 0;
+  for(o = origins; o < origins + num_origins; o++)
+  {
+    if(listed(o->accused, o->count, addr) && counts(o))
+      n++;
+  }
+  return n;
+}
+
+static uint8_t distance(const linkaddr_t* addr)
+{
+  // the shortest distances so far, worst kept at index worst
+  uint8_t best[BLOCKLIST_QUORUM];
+  uint8_t n = 0;
+  uint8_t worst = 0;
+  struct origin* o;
+  uint8_t i;
+
+  for(o = origins; o < origins + num_origins; o++)
+  {
+    if(!counts(o))
+      continue;
+    for(i = 0; i < o->count && !linkaddr_cmp(&o->accused[i], addr); i++);
+    if(i == o->count)
+      continue;
+    if(n < BLOCKLIST_QUORUM)
+      best[n++] = o->dist[i];
+    else if(o->dist[i] < best[worst])
+      best[worst] = o->dist[i];
+    else
+      continue;
+    for(worst = 0, i = 1; i < n; i++)
+    {
+      if(best[i] > best[worst])
+        worst = i;
+    }
+  }
+  if(n < BLOCKLIST_QUORUM || best[worst] >= BLOCKLIST_MAX_DISTANCE)
+    return NO_VERDICT;
+  return best[worst] + 1;
+}
+
+static int listed(const linkaddr_t* list, uint8_t count, const linkaddr_t* addr)
+{
+  uint8_t i;
+  for(i = 0; i < count; i++)
+  {
+    if(linkaddr_cmp(&list[i], addr))
+      return 1;
+  }
+  return 0;
+}
+
+static void update(struct origin* o, const linkaddr_t* accused,
+  const uint8_t* dist, uint8_t count)
+{
+  uint8_t i;
+  o->count = 0;
+  for(i = 0; i < count; i++)
+  {
+    if(linkaddr_cmp(&accused[i], sink_addr))
+      continue;
+    linkaddr_copy(&o->accused[o->count], &accused[i]);
+    o->dist[o->count++] = dist != NULL ? dist[i] : 0;
+  }
+}
+
+static void refresh(void* ptr)
+{
+  struct origin* o = origins;
+  uint8_t own = 0;
+  while(o < origins + num_origins)
+  {
+    if(!linkaddr_cmp(&o->addr, &linkaddr_node_addr)
+       && clock_seconds() - o->heard > BLOCKLIST_LIFETIME)
+    {
+      *o = origins[--num_origins];
+      continue;
+    }
+    if(linkaddr_cmp(&o->addr, &linkaddr_node_addr))
+      own = o->count;
+    o++;
+  }
+  // also catches trust and MAT changes since the last round
+  blocklist_reevaluate();
+  if(own > 0 || num_blocked > 0)
+    ctimer_set(&send_timer, 0, send_own, NULL);
+  ctimer_set(&refresh_timer, BLOCKLIST_REFRESH, refresh, NULL);
+}
+
+static void send_own(void* ptr)
+{
+  struct origin* o = lookup(&linkaddr_node_addr);
+  uint8_t* data;
+  uint8_t* pos;
+  uint8_t i;
+  uint8_t count = 0;
+
+  if(o == NULL)
+    return;
+  o->version = ++own_version;
+  packetbuf_clear();
+  data = packetbuf_dataptr();
+  data[0] = o->version >> 8;
+  data[1] = o->version;
+  pos = data + VERSION_LEN;
+  for(i = 0; i < o->count; i++, count++, pos += ENTRY_LEN)
+  {
+    memcpy(pos, &o->accused[i], LINKADDR_SIZE);
+    pos[LINKADDR_SIZE] = 0;
+  }
+  for(i = 0; i < num_blocked && count < BLOCKLIST_MAX_ACCUSED; i++)
+  {
+    if(listed(o->accused, o->count, &blocked[i]))
+      continue;
+    memcpy(pos, &blocked[i], LINKADDR_SIZE);
+    pos[LINKADDR_SIZE] = blocked_dist[i];
+    pos += ENTRY_LEN;
+    count++;
+  }
+  packetbuf_set_datalen(VERSION_LEN + count * ENTRY_LEN);
+  // sealed like trust vectors, relays pass the originator's MIC on
+  if(trust_auth_seal())
+    netflood_send(&flood, (uint8_t)o->version);
+}
+
+static int recv(struct netflood_conn* c, const linkaddr_t* from,
+  const linkaddr_t* originator, uint8_t seqno, uint8_t hops)
+{
+  linkaddr_t accused[BLOCKLIST_MAX_ACCUSED];
+  uint8_t dist[BLOCKLIST_MAX_ACCUSED];
+  struct origin* o;
+  const uint8_t* data;
+  uint16_t version;
+  uint8_t count;
+  uint8_t i;
+
+  // netflood only drops a seqno that is not above the last one of the
+  // same originator, which after the 8-bit seqno wraps (or the originator
+  // reboots) would drop all its lists until someone else floods; the
+  // 16-bit versions below suppress duplicates instead
+  ctimer_set(&forget_timer, 0, forget_last, NULL);
+
+  // netflood hands back our own floods, and isolated nodes get no say
+  if(linkaddr_cmp(originator, &linkaddr_node_addr)
+     || link_filter_is_blocked(originator) || blocklist_is_blocked(originator)
+     || !trust_auth_verify(originator)
+     || packetbuf_datalen() < VERSION_LEN)
+    return 0;
+  data = packetbuf_dataptr();
+  version = (data[0] << 8) | data[1];
+  count = (packetbuf_datalen() - VERSION_LEN) / ENTRY_LEN;
+  if(count > BLOCKLIST_MAX_ACCUSED)
+    count = BLOCKLIST_MAX_ACCUSED;
+
+  // without a slot there is no way to tell a duplicate, so it is not relayed
+  o = lookup(originator);
+  if(o == NULL)
+    return 0;
+  // versions only grow, so an older copy still on its way is a duplicate;
+  // a rebooted originator starts over once its old list has expired
+  if(o->heard != 0 && version <= o->version)
+    return 0;
+  o->version = version;
+  o->heard = clock_seconds();
+  for(i = 0; i < count; i++)
+  {
+    memcpy(&accused[i], data + VERSION_LEN + i * ENTRY_LEN, LINKADDR_SIZE);
+    dist[i] = data[VERSION_LEN + i * ENTRY_LEN + LINKADDR_SIZE];
+  }
+  update(o, accused, dist, count);
+  blocklist_reevaluate();
+  printf("blocklist v%u from %d.%d, %u hops, %u listed\n", version,
+    originator->u8[0], originator->u8[1], hops, o->count);
+  return 1;
+}
+
+static void forget_last(void* ptr)
+{
+  linkaddr_copy(&flood.last_originator, &linkaddr_null);
+}
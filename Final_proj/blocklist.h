@@ -0,0 +1,82 @@
+#ifndef BLOCKLIST_H_
+#define BLOCKLIST_H_
+
+#include "contiki.h"
+#include "net/rime/rime.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// floods every node's list of isolated neighbors over netflood; an address
+// listed by BLOCKLIST_QUORUM trusted neighbors (the node itself included)
+// is blocked, and the verdict goes into the node's own list, so it spreads
+// one hop further with every flood
+#ifndef BLOCKLIST_ENABLED
+#define BLOCKLIST_ENABLED 0
+#endif
+#define BLOCKLIST_CHANNEL 137
+// nodes that have to list an address before everyone blocks it
+#ifndef BLOCKLIST_QUORUM
+#define BLOCKLIST_QUORUM 2
+#endif
+// addresses one node's list carries, its own isolations first
+#ifndef BLOCKLIST_MAX_ACCUSED
+#define BLOCKLIST_MAX_ACCUSED 4
+#endif
+// lists kept; once full, untrusted originators make room for new ones
+#ifndef BLOCKLIST_MAX_ORIGINS
+#define BLOCKLIST_MAX_ORIGINS 8
+#endif
+// period after which a non-empty list is flooded again under a new version,
+// reaching nodes that joined or rebooted since
+#ifndef BLOCKLIST_REFRESH
+#define BLOCKLIST_REFRESH (60 * CLOCK_SECOND)
+#endif
+// addresses that can be blocked network-wide at once
+#ifndef BLOCKLIST_MAX_BLOCKED
+#define BLOCKLIST_MAX_BLOCKED 8
+#endif
+// hops from the isolating nodes up to which a verdict is relayed; verdicts
+// that only hold each other up count up to it and are then released
+#ifndef BLOCKLIST_MAX_DISTANCE
+#define BLOCKLIST_MAX_DISTANCE 6
+#endif
+// seconds after which a list that was not refreshed is dropped
+#ifndef BLOCKLIST_LIFETIME
+#define BLOCKLIST_LIFETIME 180
+#endif
+// time netflood waits before relaying, copies heard meanwhile suppress it
+#ifndef BLOCKLIST_QUEUE_TIME
+#define BLOCKLIST_QUEUE_TIME (CLOCK_SECOND / 2)
+#endif
+
+/* STRUCTS */
+struct blocklist_callbacks
+{
+  // returns 1 if originator is a neighbor trusted enough for its list
+  // to count towards the quorum
+  int (* trusted)(const linkaddr_t* originator);
+  // called when the network-wide verdict on addr changes
+  void (* changed)(const linkaddr_t* addr, uint8_t blocked);
+};
+
+/* FUNCTIONS */
+// opens the flood and starts the refresh timer
+// sink is never blocked, whatever the lists say
+void blocklist_open(const struct blocklist_callbacks* callbacks,
+  const linkaddr_t* sink);
+// floods the addresses the node isolated itself under a new version, from
+// a callback of its own, so it can be called while packetbuf is in use
+void blocklist_publish(const linkaddr_t* accused, uint8_t count);
+// returns 1 if at least BLOCKLIST_QUORUM trusted lists carry addr, within
+// BLOCKLIST_MAX_DISTANCE of the nodes that isolated it
+int blocklist_is_blocked(const linkaddr_t* addr);
+// recounts the votes after the trust in an originator changed
+void blocklist_reevaluate(void);
+// prints one "B <originator> v<version>" line per list, followed by the
+// addresses it carries with their distance and votes, "!" marking the
+// blocked ones
+void blocklist_report(void);
+
+#endif /* BLOCKLIST_H_ */
@@ -0,0 +1,80 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "cluster.h"
+
+#include <stdio.h>
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* UTILITY FUNCTIONS */
+// returns 1 if a is a lower node id than b
+static int addr_lower(const linkaddr_t* a, const linkaddr_t* b);
+
+/* GLOBAL VARIABLES */
+// head of the node's cluster, the node itself until a lower head is heard
+static linkaddr_t head;
+// lowest head offered in the current round
+static linkaddr_t best;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+void cluster_elect_begin(void)
+{
+  linkaddr_copy(&best, &linkaddr_node_addr);
+}
+
+void cluster_candidate(const linkaddr_t* addr)
+{
+  if(addr_lower(addr, &best))
+    linkaddr_copy(&best, addr);
+}
+
+int cluster_elect_end(void)
+{
+  if(linkaddr_cmp(&best, &head))
+    return 0;
+  linkaddr_copy(&head, &best);
+  if(cluster_is_head())
+    printf("CLUSTER head self\n");
+  else
+    printf("CLUSTER head %d.%d\n", head.u8[0], head.u8[1]);
+  return 1;
+}
+
+int cluster_is_head(void)
+{
+  // the zero address before the first round counts as heading too
+  return linkaddr_cmp(&head, &linkaddr_node_addr)
+    || linkaddr_cmp(&head, &linkaddr_null);
+}
+
+const linkaddr_t* cluster_head(void)
+{
+  return cluster_is_head() ? &linkaddr_node_addr : &head;
+}
+
+uint16_t cluster_beacon_val(uint16_t count)
+{
+  count &= ~CLUSTER_HEAD_FLAG;
+  return cluster_is_head() ? count | CLUSTER_HEAD_FLAG : count;
+}
+
+uint8_t cluster_beacon_head(uint16_t* val)
+{
+  uint8_t is_head = (*val & CLUSTER_HEAD_FLAG) != 0;
+  *val &= ~CLUSTER_HEAD_FLAG;
+  return is_head;
+}
+
+int cluster_accepts(const linkaddr_t* from)
+{
+  return cluster_is_head() || linkaddr_cmp(from, &head);
+}
+
+static int addr_lower(const linkaddr_t* a, const linkaddr_t* b)
+{
+  // node ids are stored low byte first
+  if(a->u8[1] != b->u8[1])
+    return a->u8[1] < b->u8[1];
+  return a->u8[0] < b->u8[0];
+}
@@ -0,0 +1,50 @@
+#ifndef CLUSTER_H_
+#define CLUSTER_H_
+
+#include "contiki.h"
+#include "net/rime/rime.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// hierarchical trust exchange: nodes elect cluster heads, members report
+// only where they disagree with their head and heads broadcast compact
+// summaries of suspects and isolated nodes instead of whole tables
+#ifndef CLUSTER_ENABLED
+#define CLUSTER_ENABLED 0
+#endif
+// trust below which a node is listed in a head's summary
+#ifndef CLUSTER_SUSPECT_TRUST
+#define CLUSTER_SUSPECT_TRUST 90
+#endif
+// difference to the head's summary from which a member reports a node
+#ifndef CLUSTER_REPORT_DELTA
+#define CLUSTER_REPORT_DELTA 10
+#endif
+// bit of the discovery beacon value set by cluster heads, the rest of the
+// value stays the number of neighbors of the sender
+#define CLUSTER_HEAD_FLAG 0x8000
+
+/* FUNCTIONS */
+// starts an election round
+// lowest id wins: a node heads its own cluster unless a trusted neighbor
+// with a lower address already heads one
+void cluster_elect_begin(void);
+// offers a trusted neighbor that announces itself as head
+void cluster_candidate(const linkaddr_t* addr);
+// ends the round, returns 1 if the node's head changed
+int cluster_elect_end(void);
+// returns 1 if the node heads its cluster
+int cluster_is_head(void);
+// returns the head of the node's cluster, its own address when it is head
+const linkaddr_t* cluster_head(void);
+// beacon value announcing count neighbors and the node's role
+uint16_t cluster_beacon_val(uint16_t count);
+// strips the head flag from a received beacon value, returns it
+uint8_t cluster_beacon_head(uint16_t* val);
+// returns 1 if a trust vector from a neighbor is merged: heads take
+// reports and summaries from everyone, members only their head's summary
+int cluster_accepts(const linkaddr_t* from);
+
+#endif /* CLUSTER_H_ */
@@ -0,0 +1,33 @@
+#ifndef DATA_HEADER_H_
+#define DATA_HEADER_H_
+
+#include "contiki.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* ENUMS */
+// what follows the header of a multihop payload
+enum data_type
+{
+  // the application payload of one originator
+  DATA_PLAIN,
+  // records of several plain messages merged by a relay, see aggregate.h
+  DATA_AGGREGATE
+};
+
+/* STRUCTS */
+// header in front of every multihop payload
+struct data_header
+{
+  // per-originator sequence number, used to drop duplicates and loops
+  uint16_t seqno;
+  // clock_time() at the originator; latency at the sink is only as exact
+  // as the clocks agree (in Cooja, up to the mote startup delay)
+  clock_time_t timestamp;
+  // relays the packet went through, incremented by forward()
+  uint8_t hops;
+  // one of enum data_type
+  uint8_t type;
+};
+
+#endif /* DATA_HEADER_H_ */
@@ -0,0 +1,57 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "dup-cache.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* STRUCTS */
+// one remembered packet
+struct dup_entry
+{
+  linkaddr_t originator;
+  uint16_t seqno;
+  uint8_t type;
+};
+
+/* UTILITY FUNCTIONS */
+// folds originator and seqno into one byte
+static uint8_t dup_hash(const linkaddr_t* originator, uint16_t seqno);
+
+/* GLOBAL VARIABLES */
+// ring of remembered packets, oldest overwritten first
+static struct dup_entry entries[DUP_CACHE_SIZE];
+// hash of each entry, scanned before comparing full keys
+static uint8_t hashes[DUP_CACHE_SIZE];
+// number of valid entries
+static uint8_t used;
+// slot the next packet is stored in
+static uint8_t next;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+int dup_cache_seen(const linkaddr_t* originator, uint16_t seqno, uint8_t type)
+{
+  uint8_t h = dup_hash(originator, seqno);
+  uint8_t i;
+
+  for(i = 0; i < used; i++)
+  {
+    if(hashes[i] == h && entries[i].seqno == seqno && entries[i].type == type
+       && linkaddr_cmp(&entries[i].originator, originator))
+      return 1;
+  }
+
+  linkaddr_copy(&entries[next].originator, originator);
+  entries[next].seqno = seqno;
+  entries[next].type = type;
+  hashes[next] = h;
+  next = (next + 1) % DUP_CACHE_SIZE;
+  if(used < DUP_CACHE_SIZE)
+    used++;
+  return 0;
+}
+
+static uint8_t dup_hash(const linkaddr_t* originator, uint16_t seqno)
+{
+  return originator->u8[0] ^ (originator->u8[1] << 3) ^ seqno ^ (seqno >> 8);
+}
@@ -0,0 +1,21 @@
+#ifndef DUP_CACHE_H_
+#define DUP_CACHE_H_
+
+#include "net/rime/rime.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// number of recently seen packets remembered per node
+#ifndef DUP_CACHE_SIZE
+#define DUP_CACHE_SIZE 16
+#endif
+
+/* FUNCTIONS */
+// returns 1 if (originator, seqno, type) was seen recently,
+// otherwise records it, evicting the oldest entry, and returns 0;
+// type keeps the sequence spaces of plain and aggregate packets apart
+int dup_cache_seen(const linkaddr_t* originator, uint16_t seqno, uint8_t type);
+
+#endif /* DUP_CACHE_H_ */
@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+# footprint report of a Sky firmware from the linker map
+#
+# attributes the flash (.text, .rodata, initialised .data) and RAM (.data,
+# .bss, .noinit) of every linked object to a module: the project sources,
+# Contiki's files, printf and the soft-float library. The RAM left above
+# .noinit is the stack. Given the firmware ELF and nm, the largest RAM
+# symbols (neighbor_mem, queuebuf pools, ...) are listed too, since static
+# buffers do not show up in the map.
+#
+# exits with 1 if a budget is exceeded, so that make stops
+#
+# ar keeps at most 15 characters of a member name, so contiki-sky.a lists
+# chameleon-bitopt.o as chameleon-bitop; such names are completed from the
+# objects the archive was built from (--objdir), and --module-budget takes
+# the full name, e.g. contiki:chameleon-bitopt
+#
+# usage: footprint.py [--elf Trust_node.sky] [--nm msp430-nm]
+#                     [--objdir obj_sky]
+#                     [--rom-budget N] [--ram-budget N] [--stack-min N]
+#                     [--module-budget NAME=N ...] contiki-sky.map
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+# output sections stored in flash and kept in RAM
+ROM_SECTIONS = ('.text', '.rodata', '.data', '.vectors')
+RAM_SECTIONS = ('.data', '.bss', '.noinit')
+
+# objects of the C and gcc runtime counted under a name of their own
+PRINTF_OBJECTS = ('printf.o', 'vuprintf.o', 'puts.o', 'putchar.o',
+                  'sprintf.o', 'snprintf.o', 'vsnprintf.o')
+FLOAT_OBJECT = re.compile(r'_(sf|df)\.o$|_sf_to_|_to_sf|_df_to_|_to_df'
+                          r'|_thenan_|fp-bit')
+
+OUTPUT_SECTION = re.compile(r'^(\.\S+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)')
+INPUT_SECTION = re.compile(r'^ (\.\S+|COMMON)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*))?$')
+INPUT_CONTINUED = re.compile(r'^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$')
+MEMORY_REGION = re.compile(r'^(\w+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)')
+END_SYMBOL = re.compile(r'^\s+0x([0-9a-f]+)\s+_end = \.')
+# longest archive member name ar stores without truncating it
+AR_NAME_MAX = 15
+
+
+def object_names(objdir):
+    """Returns the object files in objdir, empty if there is none."""
+    try:
+        return sorted(n for n in os.listdir(objdir) if n.endswith('.o'))
+    except OSError:
+        return []
+
+
+def full_member(name, objects):
+    """Completes an archive member name ar truncated, if only one object
+    of objects starts with it."""
+    if len(name) != AR_NAME_MAX or name.endswith('.o'):
+        return name
+    matches = [o for o in objects if o.startswith(name)]
+    return matches[0] if len(matches) == 1 else name
+
+
+def module_of(obj, objects=()):
+    """Names the module an object file of the map belongs to."""
+    member = re.search(r'\(([^)]+)\)$', obj)
+    name = member.group(1) if member else obj
+    base = name.rsplit('/', 1)[-1]
+    if member:
+        base = full_member(base, objects)
+    if base in PRINTF_OBJECTS:
+        return 'printf'
+    if FLOAT_OBJECT.search(base):
+        return 'float'
+    if 'libc.a' in obj or 'libgcc' in obj or 'libcrt0' in obj \
+            or obj.endswith('.o') and obj.startswith('/usr'):
+        return 'runtime'
+    if 'contiki-' in obj and member:
+        return 'contiki:' + re.sub(r'\.o$', '', base)
+    # project sources: obj_sky/attack.o, Trust_node.co
+    return re.sub(r'\.c?o$', '', base)
+
+
+def parse_map(path, objects=()):
+    """Returns {module: [rom, ram]}, the RAM region and the end of .noinit."""
+    modules = {}
+    ram_region = None
+    end = None
+    output = None
+    pending = None
+    in_memory = False
+    in_script = False
+
+    with open(path) as f:
+        for line in f:
+            line = line.rstrip('\n')
+            if line.startswith('Memory Configuration'):
+                in_memory = True
+                continue
+            if line.startswith('Linker script and memory map'):
+                in_memory = False
+                in_script = True
+                continue
+            if in_memory:
+                m = MEMORY_REGION.match(line)
+                if m and m.group(1) == 'ram':
+                    ram_region = (int(m.group(2), 16), int(m.group(3), 16))
+                continue
+            if not in_script:
+                continue
+            m = END_SYMBOL.match(line)
+            if m:
+                end = int(m.group(1), 16)
+                continue
+            m = OUTPUT_SECTION.match(line)
+            if m:
+                output = m.group(1)
+                pending = None
+                continue
+            if pending is not None:
+                m = INPUT_CONTINUED.match(line)
+                pending = None
+                if m:
+                    account(modules, output, int(m.group(2), 16), m.group(3),
+                            objects)
+                continue
+            m = INPUT_SECTION.match(line)
+            if m:
+                if m.group(2) is None:
+                    # long section names put the numbers on the next line
+                    pending = m.group(1)
+                else:
+                    account(modules, output, int(m.group(3), 16), m.group(4),
+                            objects)
+    return modules, ram_region, end
+
+
+def account(modules, output, size, obj, objects):
+    if size == 0 or output is None:
+        return
+    sizes = modules.setdefault(module_of(obj.strip(), objects), [0, 0])
+    if output.startswith(ROM_SECTIONS):
+        sizes[0] += size
+    if output.startswith(RAM_SECTIONS):
+        sizes[1] += size
+
+
+def ram_symbols(elf, nm, count):
+    """Returns the count largest data symbols of elf as (size, name)."""
+    try:
+        out = subprocess.run([nm, '-S', '--size-sort', elf], check=True,
+                             capture_output=True, text=True).stdout
+    except (OSError, subprocess.CalledProcessError) as e:
+        print('footprint: no symbols, %s' % e, file=sys.stderr)
+        return []
+    symbols = []
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[2] in 'bBdD':
+            symbols.append((int(fields[1], 16), fields[3]))
+    return sorted(symbols, reverse=True)[:count]
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__)
+    p.add_argument('map')
+    p.add_argument('--elf')
+    p.add_argument('--nm', default='msp430-nm')
+    p.add_argument('--objdir', help='objects of the Contiki archive, '
+                   'default obj_sky next to the map')
+    p.add_argument('--rom-budget', type=int)
+    p.add_argument('--ram-budget', type=int)
+    p.add_argument('--stack-min', type=int)
+    p.add_argument('--module-budget', action='append', default=[],
+                   metavar='NAME=BYTES', help='RAM budget of one module')
+    p.add_argument('--symbols', type=int, default=10,
+                   help='largest RAM symbols listed')
+    args = p.parse_args()
+
+    objdir = args.objdir or os.path.join(os.path.dirname(args.map), 'obj_sky')
+    modules, ram_region, end = parse_map(args.map, object_names(objdir))
+    rom = sum(s[0] for s in modules.values())
+    ram = sum(s[1] for s in modules.values())
+    stack = ram_region[0] + ram_region[1] - end \
+        if ram_region and end is not None else None
+
+    print('FOOTPRINT %s rom %d ram %d stack %s' % (
+        args.elf or args.map, rom, ram,
+        stack if stack is not None else '?'))
+    print('%-32s %7s %7s' % ('module', 'rom', 'ram'))
+    for name, (r, m) in sorted(modules.items(), key=lambda i: -i[1][1] - i[1][0]):
+        print('%-32s %7d %7d' % (name, r, m))
+    if args.elf:
+        print('largest RAM symbols')
+        for size, name in ram_symbols(args.elf, args.nm, args.symbols):
+            print('%-32s %7d' % (name, size))
+
+    failures = []
+    if args.rom_budget is not None and rom > args.rom_budget:
+        failures.append('rom %d > %d' % (rom, args.rom_budget))
+    if args.ram_budget is not None and ram > args.ram_budget:
+        failures.append('ram %d > %d' % (ram, args.ram_budget))
+    if args.stack_min is not None and stack is not None \
+            and stack < args.stack_min:
+        failures.append('stack %d < %d' % (stack, args.stack_min))
+    for budget in args.module_budget:
+        name, _, limit = budget.partition('=')
+        used = modules.get(name, [0, 0])[1]
+        if used > int(limit):
+            failures.append('%s ram %d > %s' % (name, used, limit))
+    for failure in failures:
+        print('FOOTPRINT over budget: %s' % failure, file=sys.stderr)
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,161 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "net/queuebuf.h"
+#include "lib/list.h"
+#include "lib/memb.h"
+#include "fwd-queue.h"
+
+#include <stdio.h>
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* STRUCTS */
+// one queued packet
+struct fwd_item
+{
+  struct fwd_item* next;
+  struct queuebuf* buf;
+  int trust;
+};
+// packets waiting for one next hop
+struct fwd_queue
+{
+  linkaddr_t nexthop;
+  LIST_STRUCT(items);
+  uint8_t len;
+  struct ctimer flush_timer;
+};
+
+/* UTILITY FUNCTIONS */
+// returns the queue of nexthop, claiming an idle one if needed
+static struct fwd_queue* lookup(const linkaddr_t* nexthop);
+// sends every packet of a queue back to back and releases the queue
+static void flush(void* _q);
+// frees one item and its buffer
+static void free_item(struct fwd_queue* q, struct fwd_item* item);
+
+/* GLOBAL VARIABLES */
+static struct fwd_queue queues[FWD_QUEUE_HOPS];
+MEMB(item_mem, struct fwd_item, FWD_QUEUE_HOPS * FWD_QUEUE_DEPTH);
+static fwd_queue_send_t send_cb;
+// packets queued right now and the most ever queued at once
+static uint8_t occupancy;
+static uint8_t max_occupancy;
+// packets dropped because a queue or the buffer pool was full
+static uint16_t dropped;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+void fwd_queue_init(fwd_queue_send_t send)
+{
+  uint8_t i;
+  send_cb = send;
+  memb_init(&item_mem);
+  for(i = 0; i < FWD_QUEUE_HOPS; i++)
+  {
+    LIST_STRUCT_INIT(&queues[i], items);
+    queues[i].len = 0;
+  }
+  occupancy = max_occupancy = 0;
+  dropped = 0;
+}
+
+int fwd_queue_enqueue(const linkaddr_t* nexthop, int trust)
+{
+  struct fwd_queue* q = lookup(nexthop);
+  struct fwd_item* item;
+
+  if(q == NULL)
+    return 0;
+
+  if(q->len == FWD_QUEUE_DEPTH)
+  {
+#if FWD_QUEUE_POLICY == FWD_QUEUE_DROP_LOWEST_TRUST
+    struct fwd_item* victim = NULL;
+    for(item = list_head(q->items); item != NULL; item = item->next)
+    {
+      if(victim == NULL || item->trust < victim->trust)
+        victim = item;
+    }
+    if(victim->trust >= trust)
+    {
+      dropped++;
+      return 1;
+    }
+    free_item(q, victim);
+    dropped++;
+#else
+    dropped++;
+    return 1;
+#endif
+  }
+
+  item = memb_alloc(&item_mem);
+  if(item == NULL)
+  {
+    dropped++;
+    return 1;
+  }
+  item->buf = queuebuf_new_from_packetbuf();
+  if(item->buf == NULL)
+  {
+    memb_free(&item_mem, item);
+    dropped++;
+    return 1;
+  }
+  item->trust = trust;
+  list_add(q->items, item);
+  q->len++;
+  if(++occupancy > max_occupancy)
+    max_occupancy = occupancy;
+  if(q->len == 1)
+    ctimer_set(&q->flush_timer, FWD_QUEUE_FLUSH_DELAY, flush, q);
+  return 1;
+}
+
+void fwd_queue_report(void)
+{
+  printf("QUEUE occupancy %u max %u dropped %u\n",
+    occupancy, max_occupancy, dropped);
+}
+
+static struct fwd_queue* lookup(const linkaddr_t* nexthop)
+{
+  struct fwd_queue* idle = NULL;
+  uint8_t i;
+  for(i = 0; i < FWD_QUEUE_HOPS; i++)
+  {
+    if(queues[i].len == 0)
+    {
+      if(idle == NULL)
+        idle = &queues[i];
+    }
+    else if(linkaddr_cmp(&queues[i].nexthop, nexthop))
+      return &queues[i];
+  }
+  if(idle != NULL)
+    linkaddr_copy(&idle->nexthop, nexthop);
+  return idle;
+}
+
+static void flush(void* _q)
+{
+  struct fwd_queue* q = _q;
+  struct fwd_item* item;
+  // one burst per next hop lets csma hand the frames to the RDC together
+  while((item = list_head(q->items)) != NULL)
+  {
+    queuebuf_to_packetbuf(item->buf);
+    free_item(q, item);
+    send_cb(&q->nexthop, q->len);
+  }
+}
+
+static void free_item(struct fwd_queue* q, struct fwd_item* item)
+{
+  list_remove(q->items, item);
+  queuebuf_free(item->buf);
+  memb_free(&item_mem, item);
+  q->len--;
+  occupancy--;
+}
@@ -0,0 +1,50 @@
+#ifndef FWD_QUEUE_H_
+#define FWD_QUEUE_H_
+
+#include "contiki.h"
+#include "net/rime/rime.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// set to 0 to hand packets to multihop as soon as forward() picks a hop
+#ifndef FWD_QUEUE_ENABLED
+#define FWD_QUEUE_ENABLED 1
+#endif
+// next hops with their own queue at the same time
+#ifndef FWD_QUEUE_HOPS
+#define FWD_QUEUE_HOPS 4
+#endif
+// packets held per next hop
+#ifndef FWD_QUEUE_DEPTH
+#define FWD_QUEUE_DEPTH 3
+#endif
+// how long a queue collects packets before they go out back to back
+#ifndef FWD_QUEUE_FLUSH_DELAY
+#define FWD_QUEUE_FLUSH_DELAY (CLOCK_SECOND / 8)
+#endif
+// what happens to a packet arriving at a full queue
+#define FWD_QUEUE_DROP_TAIL 0
+#define FWD_QUEUE_DROP_LOWEST_TRUST 1
+#ifndef FWD_QUEUE_POLICY
+#define FWD_QUEUE_POLICY FWD_QUEUE_DROP_LOWEST_TRUST
+#endif
+
+/* TYPES */
+// sends the packet restored in packetbuf to nexthop
+// remaining is the number of packets of the same flush still to come
+typedef void (*fwd_queue_send_t)(const linkaddr_t* nexthop, uint8_t remaining);
+
+/* FUNCTIONS */
+// clears all queues, send is called for every packet when its queue flushes
+void fwd_queue_init(fwd_queue_send_t send);
+// queues the packet in packetbuf for nexthop, trust is the trust of the
+// neighbor it came from and decides which packet a full queue drops
+// returns 0 if no queue could be given to nexthop and the caller must send
+// the packet itself, 1 if the packet was queued or dropped
+int fwd_queue_enqueue(const linkaddr_t* nexthop, int trust);
+// prints occupancy and drop counters
+void fwd_queue_report(void);
+
+#endif /* FWD_QUEUE_H_ */
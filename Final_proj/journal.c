@@ -0,0 +1,214 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "dev/xmem.h"
+#include "journal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+#define JOURNAL_SIZE (JOURNAL_SECTORS * JOURNAL_SECTOR_SIZE)
+#define PAGE_RECORDS (JOURNAL_PAGE_SIZE / sizeof(struct journal_record))
+#define BUFFER_RECORDS (PAGE_RECORDS + JOURNAL_BACKLOG)
+
+/* UTILITY FUNCTIONS */
+// returns 1 if r holds an event
+static int is_valid(const struct journal_record* r);
+// returns 1 if r was erased and never written
+static int is_erased(const struct journal_record* r);
+// offset of the first unwritten record, erases the journal if the flash
+// holds something else
+static unsigned long find_head(void);
+// records that still fit into the page at head
+static uint8_t page_space(void);
+static void flush_timeout(void* ptr);
+
+/* PROCESS REGISTRATION */
+// writes the buffered records when polled, out of the callbacks that add
+// them
+PROCESS(journal_process, "journal");
+// prints the journal, pausing after every page so radio and timers keep
+// running
+PROCESS(journal_dump_process, "journal dump");
+
+/* GLOBAL VARIABLES */
+// records not written yet, starting with those of the page at head
+static struct journal_record buffer[BUFFER_RECORDS];
+static uint8_t buffered;
+// records lost while the buffer was full
+static uint16_t dropped;
+// offset in the journal the buffer is written to
+static unsigned long head;
+static struct ctimer flush_timer;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+void journal_init(void)
+{
+  head = find_head();
+  buffered = 0;
+  dropped = 0;
+  process_start(&journal_process, NULL);
+  journal_add(JOURNAL_BOOT, &linkaddr_node_addr, 0);
+}
+
+void journal_add(enum journal_type type, const linkaddr_t* addr, uint8_t value)
+{
+  struct journal_record* r;
+  if(buffered == BUFFER_RECORDS)
+  {
+    dropped++;
+    return;
+  }
+  r = &buffer[buffered++];
+  r->time = clock_seconds();
+  linkaddr_copy(&r->addr, addr);
+  r->type = type;
+  r->value = value;
+  if(buffered >= page_space())
+    process_poll(&journal_process);
+  else if(buffered == 1)
+    ctimer_set(&flush_timer, JOURNAL_FLUSH_DELAY, flush_timeout, NULL);
+}
+
+void journal_flush(void)
+{
+  uint8_t count;
+  ctimer_stop(&flush_timer);
+  while(buffered > 0)
+  {
+    // a write ends where the page at head does
+    count = buffered < page_space() ? buffered : page_space();
+    xmem_pwrite(buffer, count * sizeof(buffer[0]), JOURNAL_OFFSET + head);
+    head += count * sizeof(buffer[0]);
+    buffered -= count;
+    memmove(buffer, buffer + count, buffered * sizeof(buffer[0]));
+    if(head == JOURNAL_SIZE)
+      head = 0;
+    // the next sector is erased as soon as it is entered, so the oldest
+    // records are dropped a sector at a time and the head is always the
+    // first erased record after a reboot
+    if(head % JOURNAL_SECTOR_SIZE == 0)
+      xmem_erase(JOURNAL_SECTOR_SIZE, JOURNAL_OFFSET + head);
+  }
+  if(dropped > 0)
+  {
+    printf("journal: %u records dropped\n", dropped);
+    dropped = 0;
+  }
+}
+
+void journal_dump(void)
+{
+  if(!process_is_running(&journal_dump_process))
+    process_start(&journal_dump_process, NULL);
+}
+
+PROCESS_THREAD(journal_process, ev, data)
+{
+  PROCESS_BEGIN();
+  while(1)
+  {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    journal_flush();
+  }
+  PROCESS_END();
+}
+
+PROCESS_THREAD(journal_dump_process, ev, data)
+{
+  static struct journal_record r;
+  static unsigned long pos;
+  static uint16_t count;
+
+  PROCESS_BEGIN();
+  journal_flush();
+  // the sector after the head's holds the oldest records, unless the
+  // journal never wrapped
+  pos = (head / JOURNAL_SECTOR_SIZE + 1) * JOURNAL_SECTOR_SIZE % JOURNAL_SIZE;
+  xmem_pread(&r, sizeof(r), JOURNAL_OFFSET + pos);
+  if(!is_valid(&r))
+    pos = 0;
+  count = 0;
+  while(pos != head)
+  {
+    xmem_pread(&r, sizeof(r), JOURNAL_OFFSET + pos);
+    if(is_valid(&r))
+    {
+      printf("J %lu %d.%d %u %u\n", (unsigned long)r.time,
+        r.addr.u8[0], r.addr.u8[1], r.type, r.value);
+      count++;
+    }
+    pos = (pos + sizeof(r)) % JOURNAL_SIZE;
+    if(pos % JOURNAL_PAGE_SIZE == 0)
+      PROCESS_PAUSE();
+  }
+  printf("J end %u\n", count);
+  PROCESS_END();
+}
+
+static int is_valid(const struct journal_record* r)
+{
+  return r->type > 0 && r->type < JOURNAL_TYPE_COUNT
+    && r->time != 0xffffffffUL;
+}
+
+static int is_erased(const struct journal_record* r)
+{
+  const uint8_t* p = (const uint8_t*)r;
+  uint8_t i;
+  for(i = 0; i < sizeof(*r); i++)
+    if(p[i] != 0xff)
+      return 0;
+  return 1;
+}
+
+static unsigned long find_head(void)
+{
+  struct journal_record r;
+  unsigned long page, pos;
+
+  xmem_pread(&r, sizeof(r), JOURNAL_OFFSET);
+  if(!is_valid(&r) && !is_erased(&r))
+  {
+    // never formatted
+    xmem_erase(JOURNAL_SIZE, JOURNAL_OFFSET);
+    return 0;
+  }
+  for(page = 0; page < JOURNAL_SIZE; page += JOURNAL_PAGE_SIZE)
+  {
+    xmem_pread(&r, sizeof(r), JOURNAL_OFFSET + page);
+    if(is_erased(&r))
+      break;
+  }
+  if(page == JOURNAL_SIZE)
+  {
+    // reset between filling the last sector and erasing the first
+    xmem_erase(JOURNAL_SECTOR_SIZE, JOURNAL_OFFSET);
+    return 0;
+  }
+  if(page == 0)
+    return 0;
+  // the page before the first erased one may be partly written
+  for(pos = page - JOURNAL_PAGE_SIZE; pos < page; pos += sizeof(r))
+  {
+    xmem_pread(&r, sizeof(r), JOURNAL_OFFSET + pos);
+    if(is_erased(&r))
+      return pos;
+  }
+  return page;
+}
+
+static uint8_t page_space(void)
+{
+  return (JOURNAL_PAGE_SIZE - head % JOURNAL_PAGE_SIZE)
+    / sizeof(struct journal_record);
+}
+
+static void flush_timeout(void* ptr)
+{
+  process_poll(&journal_process);
+}
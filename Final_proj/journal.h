@@ -0,0 +1,81 @@
+#ifndef JOURNAL_H_
+#define JOURNAL_H_
+
+#include "contiki.h"
+#include "net/rime/rime.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// set to 0 to keep no trust history in flash
+#ifndef JOURNAL_ENABLED
+#define JOURNAL_ENABLED 1
+#endif
+// erase unit of the Sky's M25P80 external flash
+#define JOURNAL_SECTOR_SIZE 65536UL
+// program unit of the flash, records are buffered until a page is full
+#define JOURNAL_PAGE_SIZE 256
+// the journal takes the last sectors of the flash, Coffee is shrunk in
+// project-conf.h to end where it starts
+#ifndef JOURNAL_SECTORS
+#define JOURNAL_SECTORS 2
+#endif
+#define JOURNAL_OFFSET (1024UL * 1024UL - JOURNAL_SECTORS * JOURNAL_SECTOR_SIZE)
+// longest time a record waits in RAM before its page is written anyway
+#ifndef JOURNAL_FLUSH_DELAY
+#define JOURNAL_FLUSH_DELAY (60 * CLOCK_SECOND)
+#endif
+// records buffered beyond a full page until the journal process writes it,
+// later ones are dropped
+#ifndef JOURNAL_BACKLOG
+#define JOURNAL_BACKLOG 8
+#endif
+
+/* ENUMS */
+// what a record means, 0 and 0xff mark unwritten flash
+enum journal_type
+{
+  JOURNAL_BOOT = 1,
+  // value is the trust the neighbor starts with
+  JOURNAL_NEIGHBOR,
+  // value is the new trust
+  JOURNAL_TRUST,
+  // the neighbor was blocked, value is its trust
+  JOURNAL_ISOLATED,
+  // the neighbor was unblocked, value is its trust
+  JOURNAL_RESTORED,
+  // the address was blocked network-wide, value is its trust if it is a
+  // neighbor and 0 otherwise
+  JOURNAL_BLOCKED,
+  // the network-wide block was released, value as for JOURNAL_BLOCKED
+  JOURNAL_RELEASED,
+  JOURNAL_TYPE_COUNT
+};
+
+/* STRUCTS */
+// one event, 8 bytes so that a page holds 32 of them
+struct journal_record
+{
+  // clock_seconds() at the event, restarts at every JOURNAL_BOOT
+  uint32_t time;
+  linkaddr_t addr;
+  uint8_t type;
+  uint8_t value;
+};
+
+/* FUNCTIONS */
+// finds the end of the journal in flash, starts the journal process and
+// records a boot
+void journal_init(void);
+// appends a record, which the journal process writes to flash once its
+// page is full; safe from the receive callbacks
+void journal_add(enum journal_type type, const linkaddr_t* addr, uint8_t value);
+// writes the buffered records now, erasing the next sector when the head
+// enters it; that takes about a second, so only call it from a process
+void journal_flush(void);
+// streams the journal oldest first over the serial line as
+// "J <time> <addr> <type> <value>" lines, ended by "J end <count>"
+void journal_dump(void);
+
+#endif /* JOURNAL_H_ */
@@ -0,0 +1,98 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "net/netstack.h"
+#include "link-filter.h"
+
+#include <stdio.h>
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* UTILITY FUNCTIONS */
+// returns the slot holding addr, or -1
+static int find(const linkaddr_t* addr);
+// initializes the filter and Rime below it
+static void init(void);
+// called by the MAC for every received frame
+static void input(void);
+
+/* GLOBAL VARIABLES */
+const struct network_driver link_filter_driver = {"link filter", init, input};
+// blocked link addresses, the first num_blocked are valid
+static linkaddr_t blocked[LINK_FILTER_MAX_BLOCKED];
+static uint8_t num_blocked;
+// frames dropped by the filter
+static uint16_t dropped;
+// blocks refused because all slots were taken
+static uint16_t overflow;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+int link_filter_block(const linkaddr_t* addr)
+{
+  if(find(addr) >= 0)
+    return 1;
+  if(num_blocked == LINK_FILTER_MAX_BLOCKED)
+  {
+    overflow++;
+    printf("link filter full, %d.%d not blocked\n", addr->u8[0], addr->u8[1]);
+    return 0;
+  }
+  linkaddr_copy(&blocked[num_blocked++], addr);
+  return 1;
+}
+
+void link_filter_unblock(const linkaddr_t* addr)
+{
+  int i = find(addr);
+  if(i < 0)
+    return;
+  // keep the valid entries packed at the front
+  linkaddr_copy(&blocked[i], &blocked[--num_blocked]);
+}
+
+int link_filter_is_blocked(const linkaddr_t* addr)
+{
+  return find(addr) >= 0;
+}
+
+uint16_t link_filter_dropped(void)
+{
+  return dropped;
+}
+
+uint16_t link_filter_overflow(void)
+{
+  return overflow;
+}
+
+static int find(const linkaddr_t* addr)
+{
+  uint8_t i;
+  for(i = 0; i < num_blocked; i++)
+  {
+    if(linkaddr_cmp(&blocked[i], addr))
+      return i;
+  }
+  return -1;
+}
+
+static void init(void)
+{
+  num_blocked = 0;
+  dropped = 0;
+  overflow = 0;
+  rime_driver.init();
+}
+
+static void input(void)
+{
+  // the framer has already filled in the link-layer sender, so a blocked
+  // frame is dropped before chameleon parses the Rime headers or any
+  // connection callback runs
+  if(num_blocked > 0 && find(packetbuf_addr(PACKETBUF_ADDR_SENDER)) >= 0)
+  {
+    dropped++;
+    return;
+  }
+  rime_driver.input();
+}
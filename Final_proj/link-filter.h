@@ -0,0 +1,34 @@
+#ifndef LINK_FILTER_H_
+#define LINK_FILTER_H_
+
+#include "net/rime/rime.h"
+#include "net/netstack.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// link addresses that can be blocked at once; every neighbor of the
+// table can be isolated, so keep it at Trust_node's MAX_NEIGHBORS or above
+#ifndef LINK_FILTER_MAX_BLOCKED
+#define LINK_FILTER_MAX_BLOCKED 16
+#endif
+
+/* FUNCTIONS */
+// drops all further frames from addr before Rime parses them,
+// returns 0 if the filter is full and addr stays unblocked
+int link_filter_block(const linkaddr_t* addr);
+// lets frames from addr through again
+void link_filter_unblock(const linkaddr_t* addr);
+// returns 1 if addr is blocked
+int link_filter_is_blocked(const linkaddr_t* addr);
+// number of frames dropped so far
+uint16_t link_filter_dropped(void);
+// number of addresses that could not be blocked because the filter was full
+uint16_t link_filter_overflow(void);
+
+// network driver sitting between the MAC and Rime
+// select it with NETSTACK_CONF_NETWORK in project-conf.h
+extern const struct network_driver link_filter_driver;
+
+#endif /* LINK_FILTER_H_ */
@@ -0,0 +1,92 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "link-quality.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// weights of a new sample, out of 8; acknowledgements are measured, so
+// they count more than the ETX guessed from a received frame
+#define RX_ALPHA 2
+#define TX_ALPHA 4
+
+/* UTILITY FUNCTIONS */
+// mixes a sample into an average with weight alpha out of 8
+static int ewma(int avg, int sample, int alpha);
+// ETX guessed from the quality of a frame received over the link
+static uint16_t etx_from_rx(int8_t rssi, uint8_t lqi);
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+void link_quality_init(struct link_quality* q)
+{
+  q->rssi = 0;
+  q->lqi = 0;
+  q->etx = 0;
+}
+
+void link_quality_rx(struct link_quality* q)
+{
+  int8_t rssi = (int16_t)packetbuf_attr(PACKETBUF_ATTR_RSSI);
+  uint8_t lqi = packetbuf_attr(PACKETBUF_ATTR_LINK_QUALITY);
+  uint16_t etx = etx_from_rx(rssi, lqi);
+
+  if(q->etx == 0)
+  {
+    q->rssi = rssi;
+    q->lqi = lqi;
+    q->etx = etx;
+    return;
+  }
+  q->rssi = ewma(q->rssi, rssi, RX_ALPHA);
+  q->lqi = ewma(q->lqi, lqi, RX_ALPHA);
+  q->etx = ewma(q->etx, etx, RX_ALPHA);
+}
+
+void link_quality_tx(struct link_quality* q, uint8_t retransmissions)
+{
+  uint16_t etx = (retransmissions + 1) * LINK_QUALITY_ETX_ONE;
+  if(etx > LINK_QUALITY_MAX_ETX)
+    etx = LINK_QUALITY_MAX_ETX;
+  q->etx = q->etx == 0 ? etx : ewma(q->etx, etx, TX_ALPHA);
+}
+
+void link_quality_failed(struct link_quality* q)
+{
+  q->etx = q->etx == 0 ? LINK_QUALITY_MAX_ETX :
+    ewma(q->etx, LINK_QUALITY_MAX_ETX, TX_ALPHA);
+}
+
+int link_quality_weight(const struct link_quality* q, int trust)
+{
+  int w;
+  // links nothing was measured on yet count as perfect
+  if(q->etx <= LINK_QUALITY_ETX_ONE)
+    return trust;
+  w = trust * LINK_QUALITY_ETX_ONE / q->etx;
+  // every link keeps a chance, so a bad estimate can still recover
+  return w > 0 ? w : 1;
+}
+
+static int ewma(int avg, int sample, int alpha)
+{
+  return (avg * (8 - alpha) + sample * alpha) / 8;
+}
+
+static uint16_t etx_from_rx(int8_t rssi, uint8_t lqi)
+{
+  uint16_t etx;
+  if(lqi >= LINK_QUALITY_GOOD_LQI)
+    etx = LINK_QUALITY_ETX_ONE;
+  else if(lqi <= LINK_QUALITY_LOST_LQI)
+    return LINK_QUALITY_MAX_ETX;
+  else
+    // the delivery ratio falls about linearly between the two LQI bounds
+    etx = LINK_QUALITY_ETX_ONE *
+      (LINK_QUALITY_GOOD_LQI - LINK_QUALITY_LOST_LQI) /
+      (lqi - LINK_QUALITY_LOST_LQI);
+  if(rssi < LINK_QUALITY_WEAK_RSSI)
+    etx *= 2;
+  return etx > LINK_QUALITY_MAX_ETX ? LINK_QUALITY_MAX_ETX : etx;
+}
@@ -0,0 +1,54 @@
+#ifndef LINK_QUALITY_H_
+#define LINK_QUALITY_H_
+
+#include "contiki.h"
+#include "net/rime/rime.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// fixed point scale of the ETX, LINK_QUALITY_ETX_ONE is one transmission
+#define LINK_QUALITY_ETX_ONE 16
+// ETX given to links that keep failing, or that are barely heard
+#ifndef LINK_QUALITY_MAX_ETX
+#define LINK_QUALITY_MAX_ETX (8 * LINK_QUALITY_ETX_ONE)
+#endif
+// CC2420 LQI from which frames practically always arrive
+#ifndef LINK_QUALITY_GOOD_LQI
+#define LINK_QUALITY_GOOD_LQI 100
+#endif
+// CC2420 LQI at which frames practically never arrive
+#ifndef LINK_QUALITY_LOST_LQI
+#define LINK_QUALITY_LOST_LQI 50
+#endif
+// RSSI in dBm close to the radio sensitivity, counted as twice the cost
+#ifndef LINK_QUALITY_WEAK_RSSI
+#define LINK_QUALITY_WEAK_RSSI -88
+#endif
+
+/* STRUCTS */
+// estimate of one link, kept in the neighbor table
+struct link_quality
+{
+  // averages of the frames received over the link
+  int8_t rssi;
+  uint8_t lqi;
+  // expected transmissions per delivered frame, LINK_QUALITY_ETX_ONE based
+  uint16_t etx;
+};
+
+/* FUNCTIONS */
+// starts a link at a perfect estimate, the first frame replaces it
+void link_quality_init(struct link_quality* q);
+// feeds the RSSI and LQI of the frame in packetbuf
+void link_quality_rx(struct link_quality* q);
+// feeds an acknowledged transmission that took retransmissions extra tries
+void link_quality_tx(struct link_quality* q, uint8_t retransmissions);
+// feeds a transmission that was never acknowledged
+void link_quality_failed(struct link_quality* q);
+// scales trust by the link cost, used to weight next-hop selection
+// never returns less than 1
+int link_quality_weight(const struct link_quality* q, int trust);
+
+#endif /* LINK_QUALITY_H_ */
@@ -0,0 +1,201 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "net/llsec/anti-replay.h"
+#include "lib/aes-128.h"
+#include "lib/ccm-star.h"
+#include "link-sec.h"
+#include "trust-auth.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+#if LINK_SEC_ENABLED
+/* MACROS */
+
+// the nonce holds four addresses, the counter and the hop count
+#if 4 * LINKADDR_SIZE + LINK_SEC_COUNTER_LEN + 1 > CCM_STAR_NONCE_LENGTH
+#error "link-sec needs 2-byte link addresses"
+#endif
+
+/* UTILITY FUNCTIONS */
+// encrypts the zero-padded address a with key into out
+static void encrypt_addr(uint8_t* out, const uint8_t* key, const linkaddr_t* a);
+// computes the MIC of the first len bytes of packetbuf for one hop
+static void compute_mic(uint8_t* mic, const struct link_key* k,
+  const linkaddr_t* sender, const linkaddr_t* receiver, const uint8_t* counter,
+  uint8_t hops, uint8_t len);
+// erases the master key at the end of the bootstrap window
+static void end_bootstrap(void* ptr);
+
+/* GLOBAL VARIABLES */
+// in RAM so it can be erased; only the firmware image keeps a copy
+static uint8_t master_key[16] = LINK_SEC_MASTER_KEY;
+// the master key applied to this node's address
+static uint8_t node_key[16];
+// set until end_bootstrap() runs
+static uint8_t bootstrapping;
+static struct ctimer bootstrap_timer;
+#endif
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+void link_sec_init(void)
+{
+#if LINK_SEC_ENABLED
+  encrypt_addr(node_key, master_key, &linkaddr_node_addr);
+  bootstrapping = 1;
+  ctimer_set(&bootstrap_timer, LINK_SEC_BOOTSTRAP, end_bootstrap, NULL);
+#endif
+}
+
+void link_sec_clear(struct link_key* k)
+{
+  memset(k, 0, sizeof(*k));
+}
+
+int link_sec_derive(struct link_key* k, const linkaddr_t* peer)
+{
+#if LINK_SEC_ENABLED
+  uint8_t peer_key[16];
+
+  // once derived, the key only has to be switched back on
+  if(!k->known)
+  {
+    if(memcmp(&linkaddr_node_addr, peer, LINKADDR_SIZE) > 0)
+      encrypt_addr(k->key, node_key, peer);
+    else if(bootstrapping)
+    {
+      encrypt_addr(peer_key, master_key, peer);
+      encrypt_addr(k->key, peer_key, &linkaddr_node_addr);
+    }
+    else
+      return 0;
+    k->known = 1;
+  }
+#else
+  k->known = 1;
+#endif
+  k->valid = 1;
+  return 1;
+}
+
+void link_sec_revoke(struct link_key* k)
+{
+  // the key stays known: without the master key it could not be derived
+  // again, and the peer holds it anyway
+  k->valid = 0;
+}
+
+int link_sec_seal(const struct link_key* k, const linkaddr_t* receiver)
+{
+  if(!k->valid)
+    return 0;
+#if LINK_SEC_ENABLED
+  {
+    uint8_t* data = packetbuf_dataptr();
+    uint16_t len = packetbuf_datalen();
+    uint32_t counter;
+    if(len + LINK_SEC_COUNTER_LEN + LINK_SEC_MIC_LEN > PACKETBUF_SIZE)
+      return 0;
+    counter = trust_auth_next_counter();
+    data[len] = counter >> 24;
+    data[len + 1] = counter >> 16;
+    data[len + 2] = counter >> 8;
+    data[len + 3] = counter;
+    compute_mic(data + len + LINK_SEC_COUNTER_LEN, k, &linkaddr_node_addr,
+      receiver, data + len, packetbuf_attr(PACKETBUF_ATTR_HOPS), len);
+    packetbuf_set_datalen(len + LINK_SEC_COUNTER_LEN + LINK_SEC_MIC_LEN);
+  }
+#endif
+  return 1;
+}
+
+void link_sec_unseal(void)
+{
+#if LINK_SEC_ENABLED
+  packetbuf_set_datalen(packetbuf_datalen() - LINK_SEC_COUNTER_LEN
+    - LINK_SEC_MIC_LEN);
+#endif
+}
+
+int link_sec_verify(const struct link_key* k, const linkaddr_t* sender,
+  uint8_t hops)
+{
+  if(!k->valid)
+    return 0;
+#if LINK_SEC_ENABLED
+  {
+    uint8_t* data = packetbuf_dataptr();
+    uint16_t len = packetbuf_datalen();
+    uint8_t* counter;
+    uint8_t mic[LINK_SEC_MIC_LEN];
+    if(len < LINK_SEC_COUNTER_LEN + LINK_SEC_MIC_LEN)
+      return 0;
+    len -= LINK_SEC_COUNTER_LEN + LINK_SEC_MIC_LEN;
+    counter = data + len;
+    compute_mic(mic, k, sender, &linkaddr_node_addr, counter, hops, len);
+    if(memcmp(mic, counter + LINK_SEC_COUNTER_LEN, LINK_SEC_MIC_LEN) != 0)
+      return 0;
+    // where anti-replay reads it, as in trust_auth_verify()
+    packetbuf_set_attr(PACKETBUF_ATTR_FRAME_COUNTER_BYTES_2_3,
+      (counter[0] << 8) | counter[1]);
+    packetbuf_set_attr(PACKETBUF_ATTR_FRAME_COUNTER_BYTES_0_1,
+      (counter[2] << 8) | counter[3]);
+    packetbuf_set_datalen(len);
+  }
+#endif
+  return 1;
+}
+
+int link_sec_replayed(struct anti_replay_info* info)
+{
+#if LINK_SEC_ENABLED
+  return anti_replay_was_replayed(info);
+#else
+  return 0;
+#endif
+}
+
+#if LINK_SEC_ENABLED
+static void encrypt_addr(uint8_t* out, const uint8_t* key, const linkaddr_t* a)
+{
+  memset(out, 0, 16);
+  memcpy(out, a, LINKADDR_SIZE);
+  AES_128.set_key(key);
+  AES_128.encrypt(out);
+}
+
+static void compute_mic(uint8_t* mic, const struct link_key* k,
+  const linkaddr_t* sender, const linkaddr_t* receiver, const uint8_t* counter,
+  uint8_t hops, uint8_t len)
+{
+  uint8_t nonce[CCM_STAR_NONCE_LENGTH];
+
+  // the multihop attributes travel in the Rime header, outside the data;
+  // putting them into the nonce authenticates them without copying the
+  // data behind them, and the counter keeps the nonce unique
+  memset(nonce, 0, sizeof(nonce));
+  memcpy(nonce, sender, LINKADDR_SIZE);
+  memcpy(nonce + LINKADDR_SIZE, receiver, LINKADDR_SIZE);
+  memcpy(nonce + 2 * LINKADDR_SIZE, packetbuf_addr(PACKETBUF_ADDR_ESENDER),
+    LINKADDR_SIZE);
+  memcpy(nonce + 3 * LINKADDR_SIZE, packetbuf_addr(PACKETBUF_ADDR_ERECEIVER),
+    LINKADDR_SIZE);
+  memcpy(nonce + 4 * LINKADDR_SIZE, counter, LINK_SEC_COUNTER_LEN);
+  nonce[4 * LINKADDR_SIZE + LINK_SEC_COUNTER_LEN] = hops;
+  // the payload is authenticated as associated data only, which keeps a
+  // Hello frame at two AES blocks on the radio's engine and no CTR pass
+  CCM_STAR.set_key(k->key);
+  CCM_STAR.aead(nonce, NULL, 0, packetbuf_dataptr(), len, mic,
+    LINK_SEC_MIC_LEN, 1);
+}
+
+static void end_bootstrap(void* ptr)
+{
+  memset(master_key, 0, sizeof(master_key));
+  bootstrapping = 0;
+  printf("link-sec: bootstrap over, master key erased\n");
+}
+#endif
@@ -0,0 +1,71 @@
+#ifndef LINK_SEC_H_
+#define LINK_SEC_H_
+
+#include "net/rime/rime.h"
+#include "net/llsec/anti-replay.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// set to 0 to forward multihop data without per-hop MICs
+#ifndef LINK_SEC_ENABLED
+#define LINK_SEC_ENABLED 1
+#endif
+// bytes of the truncated CCM* MIC appended to multihop data on every hop
+#ifndef LINK_SEC_MIC_LEN
+#define LINK_SEC_MIC_LEN 4
+#endif
+// frame counter bytes between the data and the MIC
+#define LINK_SEC_COUNTER_LEN 4
+// key the node keys are derived from, held only during the bootstrap window
+#ifndef LINK_SEC_MASTER_KEY
+#define LINK_SEC_MASTER_KEY { 0x4c, 0x69, 0x6e, 0x6b, 0x4d, 0x61, 0x73, 0x74, \
+                              0x65, 0x72, 0x4b, 0x65, 0x79, 0x30, 0x30, 0x31 }
+#endif
+// time after boot at which the master key is erased; a neighbor with the
+// lower address has to be keyed before then, see link_sec_derive()
+#ifndef LINK_SEC_BOOTSTRAP
+#define LINK_SEC_BOOTSTRAP (60 * CLOCK_SECOND)
+#endif
+
+/* STRUCTS */
+// pairwise key shared with one neighbor, only used while it is trusted
+struct link_key
+{
+  uint8_t key[16];
+  // set once the key has been derived
+  uint8_t known;
+  // cleared while the neighbor is isolated
+  uint8_t valid;
+};
+
+/* FUNCTIONS */
+// derives the node's own key and starts the bootstrap window
+void link_sec_init(void);
+// forgets the key of a new neighbor entry
+void link_sec_clear(struct link_key* k);
+// derives the key shared with peer, or reinstates a revoked one; the key
+// of a pair is the higher address's node key applied to the lower address,
+// so the lower one needs the master key and can only derive it during its
+// bootstrap window; returns 0 if that is over and the key was never known
+int link_sec_derive(struct link_key* k, const linkaddr_t* peer);
+// stops sealing and accepting frames with the key
+void link_sec_revoke(struct link_key* k);
+// appends the frame counter and a MIC for the next hop to the data in
+// packetbuf; the MIC also covers the multihop originator, destination and
+// hop count attributes; returns 0 if the key is not valid or packetbuf full
+int link_sec_seal(const struct link_key* k, const linkaddr_t* receiver);
+// strips the counter and MIC this node added with link_sec_seal, to seal
+// for another hop
+void link_sec_unseal(void);
+// checks and strips the counter and MIC added by the previous hop, hops is
+// the hop count the frame arrived with; returns 0 if the key is not valid
+// or the MIC does not match
+int link_sec_verify(const struct link_key* k, const linkaddr_t* sender,
+  uint8_t hops);
+// returns 1 if the last verified frame is not newer than the previous one
+// from the same neighbor, and records its counter otherwise
+int link_sec_replayed(struct anti_replay_info* info);
+
+#endif /* LINK_SEC_H_ */
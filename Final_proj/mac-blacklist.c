@@ -0,0 +1,72 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "net/netstack.h"
+#include "net/mac/csma.h"
+#include "link-filter.h"
+#include "mac-blacklist.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* UTILITY FUNCTIONS */
+static void init(void);
+// refuses unicasts to blocked receivers before csma queues them
+static void send(mac_callback_t sent, void* ptr);
+// drops frames from blocked senders before csma sees them
+static void input(void);
+static int on(void);
+static int off(int keep_radio_on);
+static unsigned short channel_check_interval(void);
+
+/* GLOBAL VARIABLES */
+const struct mac_driver mac_blacklist_driver = {
+  "mac blacklist", init, send, input, on, off, channel_check_interval
+};
+// unicasts refused so far
+static uint16_t refused;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+uint16_t mac_blacklist_refused(void)
+{
+  return refused;
+}
+
+static void init(void)
+{
+  refused = 0;
+  csma_driver.init();
+}
+
+static void send(mac_callback_t sent, void* ptr)
+{
+  const linkaddr_t* receiver = packetbuf_addr(PACKETBUF_ADDR_RECEIVER);
+  if(!linkaddr_cmp(receiver, &linkaddr_null) && link_filter_is_blocked(receiver))
+  {
+    // report a fatal error so csma neither queues nor retransmits the frame
+    refused++;
+    mac_call_sent_callback(sent, ptr, MAC_TX_ERR_FATAL, 0);
+    return;
+  }
+  csma_driver.send(sent, ptr);
+}
+
+static void input(void)
+{
+  // frames from blocked senders are dropped, and counted, by link-filter
+  csma_driver.input();
+}
+
+static int on(void)
+{
+  return csma_driver.on();
+}
+
+static int off(int keep_radio_on)
+{
+  return csma_driver.off(keep_radio_on);
+}
+
+static unsigned short channel_check_interval(void)
+{
+  return csma_driver.channel_check_interval();
+}
@@ -0,0 +1,17 @@
+#ifndef MAC_BLACKLIST_H_
+#define MAC_BLACKLIST_H_
+
+#include "net/netstack.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* FUNCTIONS */
+// number of unicasts refused because the receiver is blocked
+uint16_t mac_blacklist_refused(void);
+
+// csma wrapper that refuses to send to addresses blocked in link-filter,
+// which drops the frames they send; select it with NETSTACK_CONF_MAC in
+// project-conf.h
+extern const struct mac_driver mac_blacklist_driver;
+
+#endif /* MAC_BLACKLIST_H_ */
@@ -0,0 +1,67 @@
+#include "contiki.h"
+#include "sys/rtimer.h"
+#include "profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* STRUCTS */
+// counters of one code path
+struct profile_counter
+{
+  uint16_t runs;
+  rtimer_clock_t min;
+  rtimer_clock_t max;
+  uint32_t total;
+  uint16_t histogram[PROFILE_BUCKETS];
+};
+
+/* GLOBAL VARIABLES */
+static struct profile_counter counters[PROFILE_COUNT];
+// names printed by the report, indexed by enum profile_id
+static const char* const names[PROFILE_COUNT] = {
+  "forward", "update_table", "broadcast_recv"
+};
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+void profile_record(enum profile_id id, rtimer_clock_t ticks)
+{
+  struct profile_counter* c = &counters[id];
+  uint8_t b = 0;
+
+  if(c->runs == 0 || ticks < c->min)
+    c->min = ticks;
+  if(ticks > c->max)
+    c->max = ticks;
+  c->runs++;
+  c->total += ticks;
+  while(b < PROFILE_BUCKETS - 1 && (ticks >> (b + 1)) != 0)
+    b++;
+  c->histogram[b]++;
+}
+
+void profile_report(void)
+{
+  struct profile_counter* c;
+  uint8_t id, b;
+
+  printf("F # ticks of %lu Hz, including the UART output of the paths\n",
+    (unsigned long)RTIMER_SECOND);
+  for(id = 0; id < PROFILE_COUNT; id++)
+  {
+    c = &counters[id];
+    printf("F %s %u %u %u %lu", names[id], c->runs, c->min, c->max,
+      c->runs > 0 ? (unsigned long)(c->total / c->runs) : 0UL);
+    for(b = 0; b < PROFILE_BUCKETS; b++)
+      printf(" %u", c->histogram[b]);
+    printf("\n");
+  }
+}
+
+void profile_reset(void)
+{
+  memset(counters, 0, sizeof(counters));
+}
@@ -0,0 +1,60 @@
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include "contiki.h"
+#include "sys/rtimer.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// set to 1 to time the hot paths, the macros compile to nothing otherwise
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED 0
+#endif
+// time source of the measurements, in rtimer ticks unless overridden
+#ifndef PROFILE_NOW
+#define PROFILE_NOW() RTIMER_NOW()
+#endif
+// buckets of the duration histograms; 16 reach the full range of a 16-bit
+// rtimer, 8 ended at 128 ticks (4 ms on the Sky), which printing one line
+// over the UART already takes
+#ifndef PROFILE_BUCKETS
+#define PROFILE_BUCKETS 16
+#endif
+
+#if PROFILE_ENABLED
+// starts timing id, at most once per block
+#define PROFILE_BEGIN(id) rtimer_clock_t profile_start_ = PROFILE_NOW()
+// accounts the time since the PROFILE_BEGIN of the block to id
+#define PROFILE_END(id) \
+  profile_record(id, (rtimer_clock_t)(PROFILE_NOW() - profile_start_))
+#else
+#define PROFILE_BEGIN(id)
+#define PROFILE_END(id)
+#endif
+
+/* ENUMS */
+// the timed code paths
+enum profile_id
+{
+  PROFILE_FORWARD,
+  PROFILE_UPDATE_TABLE,
+  PROFILE_BROADCAST_RECV,
+  PROFILE_COUNT
+};
+
+/* FUNCTIONS */
+// accounts one run of id that took ticks
+// bucket i counts [2^i, 2^(i+1)) ticks, the first also 0 and the last
+// everything longer
+void profile_record(enum profile_id id, rtimer_clock_t ticks);
+// prints one "F <name> <runs> <min> <max> <avg> <histogram>" line per path,
+// durations in ticks of RTIMER_SECOND, after an "F #" line saying so; the
+// timed paths print as they go and printf waits for the UART, so the
+// durations include that output
+void profile_report(void);
+// clears all counters, e.g. between the runs of a sweep
+void profile_reset(void);
+
+#endif /* PROFILE_H_ */
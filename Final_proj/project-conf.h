@@ -0,0 +1,18 @@
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+// run CCM* on the CC2420 stand-alone AES engine instead of software AES
+#define AES_128_CONF cc2420_aes_128_driver
+
+// drop frames from isolated neighbors before they reach Rime
+#define NETSTACK_CONF_NETWORK link_filter_driver
+// stop csma from queueing and retransmitting unicasts to isolated neighbors
+#define NETSTACK_CONF_MAC mac_blacklist_driver
+
+// end Coffee where the trust journal's sectors start (see journal.h)
+#define COFFEE_CONF_SIZE (1024UL * 1024UL - 3 * 65536UL)
+
+// relays hold packets this long so that several Hellos share one frame
+#define FWD_QUEUE_FLUSH_DELAY (2 * CLOCK_SECOND)
+
+#endif /* PROJECT_CONF_H_ */
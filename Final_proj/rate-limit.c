@@ -0,0 +1,77 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "rate-limit.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// bucket depth in clock ticks
+#define BUCKET_SIZE ((clock_time_t)(RATE_LIMIT_BURST * RATE_LIMIT_INTERVAL))
+
+/* STRUCTS */
+// token bucket of one originator
+// credit is kept in clock ticks and a message costs RATE_LIMIT_INTERVAL,
+// which avoids any division on the receive path
+struct bucket
+{
+  linkaddr_t addr;
+  clock_time_t credit;
+  clock_time_t last_refill;
+  // clock_seconds() of the last refill, clock_time() wraps every 512 s
+  unsigned long last_seconds;
+};
+
+/* UTILITY FUNCTIONS */
+// returns the bucket of an originator, allocating a full one if needed
+static struct bucket* lookup(const linkaddr_t* origin);
+
+/* GLOBAL VARIABLES */
+static struct bucket buckets[RATE_LIMIT_MAX_ORIGINS];
+// number of buckets in use
+static uint8_t num_buckets;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+int rate_limit_admit(const linkaddr_t* origin)
+{
+  struct bucket* b = lookup(origin);
+  clock_time_t now = clock_time();
+  clock_time_t elapsed = now - b->last_refill;
+  unsigned long seconds = clock_seconds();
+
+  // a silence long enough to fill the bucket may have wrapped clock_time()
+  if(seconds - b->last_seconds > BUCKET_SIZE / CLOCK_SECOND)
+    elapsed = BUCKET_SIZE;
+  b->last_refill = now;
+  b->last_seconds = seconds;
+  if(elapsed >= BUCKET_SIZE - b->credit)
+    b->credit = BUCKET_SIZE;
+  else
+    b->credit += elapsed;
+
+  if(b->credit < RATE_LIMIT_INTERVAL)
+    return 0;
+  b->credit -= RATE_LIMIT_INTERVAL;
+  return 1;
+}
+
+static struct bucket* lookup(const linkaddr_t* origin)
+{
+  struct bucket* b;
+  for(b = buckets; b < buckets + num_buckets; b++)
+  {
+    if(linkaddr_cmp(&b->addr, origin))
+      return b;
+  }
+  // once full, every new originator shares the last bucket and its tokens,
+  // so rotating addresses gain no fresh credit
+  if(num_buckets == RATE_LIMIT_MAX_ORIGINS)
+    return &buckets[RATE_LIMIT_MAX_ORIGINS - 1];
+  b = &buckets[num_buckets++];
+  linkaddr_copy(&b->addr, origin);
+  b->credit = BUCKET_SIZE;
+  b->last_refill = clock_time();
+  b->last_seconds = clock_seconds();
+  return b;
+}
@@ -0,0 +1,29 @@
+#ifndef RATE_LIMIT_H_
+#define RATE_LIMIT_H_
+
+#include "contiki.h"
+#include "net/rime/rime.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// originators with their own bucket, later ones share the last slot
+#ifndef RATE_LIMIT_MAX_ORIGINS
+#define RATE_LIMIT_MAX_ORIGINS 16
+#endif
+// sustained rate: one message per RATE_LIMIT_INTERVAL
+#ifndef RATE_LIMIT_INTERVAL
+#define RATE_LIMIT_INTERVAL (5 * CLOCK_SECOND)
+#endif
+// messages an originator may send back to back
+#ifndef RATE_LIMIT_BURST
+#define RATE_LIMIT_BURST 3
+#endif
+
+/* FUNCTIONS */
+// takes a token from the originator's bucket
+// returns 0 if the bucket is empty and the message should be shed
+int rate_limit_admit(const linkaddr_t* origin);
+
+#endif /* RATE_LIMIT_H_ */
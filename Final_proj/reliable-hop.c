@@ -0,0 +1,115 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "net/queuebuf.h"
+#include "reliable-hop.h"
+
+#include <string.h>
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* STRUCTS */
+// multihop addresses carried in front of the data, since runicast does not
+// transmit the multihop channel's attributes
+struct hop_header
+{
+  linkaddr_t originator;
+  linkaddr_t dest;
+  uint8_t hops;
+};
+
+/* UTILITY FUNCTIONS */
+static void recv(struct runicast_conn* c, const linkaddr_t* from, uint8_t seqno);
+static void sent(struct runicast_conn* c, const linkaddr_t* to, uint8_t retransmissions);
+static void timedout(struct runicast_conn* c, const linkaddr_t* to, uint8_t retransmissions);
+// hands packetbuf to runicast behind a hop header
+static int send(const linkaddr_t* nexthop, uint8_t max_retx);
+
+/* GLOBAL VARIABLES */
+static const struct runicast_callbacks runicast_call = {recv, sent, timedout};
+static struct runicast_conn runicast;
+static const struct reliable_hop_callbacks* callbacks;
+// copy of the packet in flight, runicast gives no access to its own
+static struct queuebuf* pending;
+// reroutes left for the packet in flight
+static uint8_t reroutes;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+void reliable_hop_open(const struct reliable_hop_callbacks* cb)
+{
+  callbacks = cb;
+  runicast_open(&runicast, RELIABLE_HOP_CHANNEL, &runicast_call);
+}
+
+int reliable_hop_send(const linkaddr_t* nexthop, uint8_t max_retx)
+{
+  if(runicast_is_transmitting(&runicast) || pending != NULL)
+    return 0;
+  pending = queuebuf_new_from_packetbuf();
+  if(pending == NULL)
+    return 0;
+  reroutes = RELIABLE_HOP_MAX_REROUTES;
+  if(!send(nexthop, max_retx))
+  {
+    queuebuf_free(pending);
+    pending = NULL;
+    return 0;
+  }
+  return 1;
+}
+
+static int send(const linkaddr_t* nexthop, uint8_t max_retx)
+{
+  struct hop_header h;
+  linkaddr_copy(&h.originator, packetbuf_addr(PACKETBUF_ADDR_ESENDER));
+  linkaddr_copy(&h.dest, packetbuf_addr(PACKETBUF_ADDR_ERECEIVER));
+  h.hops = packetbuf_attr(PACKETBUF_ATTR_HOPS);
+  if(!packetbuf_hdralloc(sizeof(h)))
+    return 0;
+  memcpy(packetbuf_hdrptr(), &h, sizeof(h));
+  // runicast's limit counts the first transmission too
+  return runicast_send(&runicast, nexthop, max_retx + 1) != 0;
+}
+
+static void recv(struct runicast_conn* c, const linkaddr_t* from, uint8_t seqno)
+{
+  struct hop_header h;
+  if(packetbuf_datalen() < sizeof(h))
+    return;
+  memcpy(&h, packetbuf_dataptr(), sizeof(h));
+  packetbuf_hdrreduce(sizeof(h));
+  packetbuf_set_addr(PACKETBUF_ADDR_ESENDER, &h.originator);
+  packetbuf_set_addr(PACKETBUF_ADDR_ERECEIVER, &h.dest);
+  packetbuf_set_attr(PACKETBUF_ATTR_HOPS, h.hops);
+  callbacks->input(from);
+}
+
+static void sent(struct runicast_conn* c, const linkaddr_t* to, uint8_t retransmissions)
+{
+  // runicast counts the first transmission as well
+  callbacks->sent(to, retransmissions > 0 ? retransmissions - 1 : 0);
+  queuebuf_free(pending);
+  pending = NULL;
+}
+
+static void timedout(struct runicast_conn* c, const linkaddr_t* to, uint8_t retransmissions)
+{
+  const linkaddr_t* nexthop = NULL;
+  uint8_t max_retx;
+
+  queuebuf_to_packetbuf(pending);
+  queuebuf_free(pending);
+  pending = NULL;
+  if(reroutes == 0)
+    return;
+  reroutes--;
+  nexthop = callbacks->reroute(to, &max_retx);
+  if(nexthop == NULL)
+    return;
+  pending = queuebuf_new_from_packetbuf();
+  if(pending != NULL && !send(nexthop, max_retx))
+  {
+    queuebuf_free(pending);
+    pending = NULL;
+  }
+}
@@ -0,0 +1,45 @@
+#ifndef RELIABLE_HOP_H_
+#define RELIABLE_HOP_H_
+
+#include "net/rime/rime.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// set to 1 to send multihop packets hop by hop over runicast
+#ifndef RELIABLE_HOP_ENABLED
+#define RELIABLE_HOP_ENABLED 0
+#endif
+// Rime channel of the reliable hops, next to the multihop channel
+#ifndef RELIABLE_HOP_CHANNEL
+#define RELIABLE_HOP_CHANNEL 136
+#endif
+// times a packet may be moved to another next hop after a timeout
+#ifndef RELIABLE_HOP_MAX_REROUTES
+#define RELIABLE_HOP_MAX_REROUTES 2
+#endif
+
+/* STRUCTS */
+struct reliable_hop_callbacks
+{
+  // a packet arrived from the previous hop, packetbuf holds it with the
+  // multihop addresses and hop count restored
+  void (* input)(const linkaddr_t* from);
+  // nexthop acknowledged the packet after retransmissions extra tries
+  void (* sent)(const linkaddr_t* nexthop, uint8_t retransmissions);
+  // nexthop never acknowledged the packet in packetbuf (still sealed for
+  // it); returns another next hop with the packet sealed for it, or NULL to
+  // drop it, and sets max_retx to the budget for the new hop
+  const linkaddr_t* (* reroute)(const linkaddr_t* nexthop, uint8_t* max_retx);
+};
+
+/* FUNCTIONS */
+// opens the runicast connection
+void reliable_hop_open(const struct reliable_hop_callbacks* cb);
+// sends the multihop packet in packetbuf to nexthop with up to max_retx
+// retransmissions after the first transmission; returns 0 if a transfer is
+// still pending, in which case the caller should fall back to best effort
+int reliable_hop_send(const linkaddr_t* nexthop, uint8_t max_retx);
+
+#endif /* RELIABLE_HOP_H_ */
@@ -0,0 +1,154 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "dev/button-sensor.h"
+#include "sink-stats.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* STRUCTS */
+// delivery statistics of one originator
+struct origin_stats
+{
+  linkaddr_t addr;
+  // first and highest sequence number received
+  uint16_t first_seqno;
+  uint16_t last_seqno;
+  uint16_t received;
+  // messages dropped by the rate limiter
+  uint16_t shed;
+  uint16_t latency[SINK_STATS_BUCKETS];
+  uint16_t hops[SINK_STATS_BUCKETS];
+};
+
+/* UTILITY FUNCTIONS */
+// returns the entry of an originator, allocating one if there is room
+static struct origin_stats* lookup(const linkaddr_t* origin);
+// histogram bucket of a latency in clock ticks
+static uint8_t latency_bucket(clock_time_t latency);
+
+/* PROCESS REGISTRATION */
+// prints the report when the button is pressed
+PROCESS(sink_stats_process, "sink stats process");
+
+/* GLOBAL VARIABLES */
+static struct origin_stats origins[SINK_STATS_MAX_ORIGINS];
+// number of entries in use
+static uint8_t num_origins;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+/* PROCESS THREADS */
+
+PROCESS_THREAD(sink_stats_process, ev, data)
+{
+  PROCESS_BEGIN();
+  SENSORS_ACTIVATE(button_sensor);
+  while(1)
+  {
+    PROCESS_WAIT_EVENT_UNTIL(ev == sensors_event && data == &button_sensor);
+    sink_stats_report();
+  }
+  PROCESS_END();
+}
+
+/* FUNCTIONS */
+
+void sink_stats_init(void)
+{
+  memset(origins, 0, sizeof(origins));
+  num_origins = 0;
+  process_start(&sink_stats_process, NULL);
+}
+
+void sink_stats_record(const linkaddr_t* origin, uint16_t seqno,
+  clock_time_t latency, uint8_t hops)
+{
+  struct origin_stats* s = lookup(origin);
+  if(s == NULL)
+    return;
+  if(s->received == 0)
+    s->first_seqno = s->last_seqno = seqno;
+  else if((int16_t)(seqno - s->last_seqno) > 0)
+    s->last_seqno = seqno;
+  s->received++;
+  s->latency[latency_bucket(latency)]++;
+  s->hops[hops < SINK_STATS_BUCKETS ? hops : SINK_STATS_BUCKETS - 1]++;
+}
+
+void sink_stats_shed(const linkaddr_t* origin)
+{
+  struct origin_stats* s = lookup(origin);
+  if(s != NULL)
+    s->shed++;
+}
+
+void sink_stats_report(void)
+{
+  struct origin_stats* s;
+  uint16_t expected;
+  uint8_t i;
+
+  for(s = origins; s < origins + num_origins; s++)
+  {
+    if(s->received == 0)
+    {
+      printf("STATS %d.%d rx 0 shed %u\n", s->addr.u8[0], s->addr.u8[1], s->shed);
+      continue;
+    }
+    expected = s->last_seqno - s->first_seqno + 1;
+    printf("STATS %d.%d rx %u shed %u expected %u pdr %u%% lat",
+      s->addr.u8[0], s->addr.u8[1], s->received, s->shed, expected,
+      (unsigned)((unsigned long)s->received * 100 / expected));
+    for(i = 0; i < SINK_STATS_BUCKETS; i++)
+      printf(" %u", s->latency[i]);
+    printf(" hops");
+    for(i = 0; i < SINK_STATS_BUCKETS; i++)
+      printf(" %u", s->hops[i]);
+    printf("\n");
+  }
+}
+
+void sink_stats_dump(void)
+{
+  struct origin_stats* s;
+  const uint8_t* p;
+
+  for(s = origins; s < origins + num_origins; s++)
+  {
+    printf("S ");
+    for(p = (const uint8_t*)s; p < (const uint8_t*)(s + 1); p++)
+      printf("%02x", *p);
+    printf("\n");
+  }
+}
+
+/* HELPER FUNCTIONS */
+
+static struct origin_stats* lookup(const linkaddr_t* origin)
+{
+  struct origin_stats* s;
+  for(s = origins; s < origins + num_origins; s++)
+  {
+    if(linkaddr_cmp(&s->addr, origin))
+      return s;
+  }
+  if(num_origins == SINK_STATS_MAX_ORIGINS)
+    return NULL;
+  s = &origins[num_origins++];
+  linkaddr_copy(&s->addr, origin);
+  return s;
+}
+
+static uint8_t latency_bucket(clock_time_t latency)
+{
+  uint8_t b = 0;
+  while(latency > 1 && b < SINK_STATS_BUCKETS - 1)
+  {
+    latency >>= 1;
+    b++;
+  }
+  return b;
+}
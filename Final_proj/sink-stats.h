@@ -0,0 +1,36 @@
+#ifndef SINK_STATS_H_
+#define SINK_STATS_H_
+
+#include "contiki.h"
+#include "net/rime/rime.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// originators tracked by the sink, later ones are not counted
+#ifndef SINK_STATS_MAX_ORIGINS
+#define SINK_STATS_MAX_ORIGINS 16
+#endif
+// buckets of the latency and hop count histograms
+#define SINK_STATS_BUCKETS 8
+
+/* FUNCTIONS */
+// clears the tables and starts printing a report on every button press
+void sink_stats_init(void);
+// accounts one delivered message
+// latency is in clock ticks: latency bucket i counts [2^i, 2^(i+1)) ticks,
+// the first also 0 and the last everything longer; hop bucket i counts
+// i hops, the last one i or more
+void sink_stats_record(const linkaddr_t* origin, uint16_t seqno,
+  clock_time_t latency, uint8_t hops);
+// accounts one message shed by admission control
+void sink_stats_shed(const linkaddr_t* origin);
+// prints delivery ratio and histograms of every originator
+void sink_stats_report(void);
+// prints each originator's raw counters as one "S <hex>" line: address,
+// first and last seqno, received, shed, then the latency and hop
+// histograms, all 16-bit fields in the node's byte order
+void sink_stats_dump(void);
+
+#endif /* SINK_STATS_H_ */
@@ -0,0 +1,39 @@
+#include "contiki.h"
+#include "stack-mark.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+#define PATTERN 0x5a
+
+/* GLOBAL VARIABLES */
+// provided by the msp430 linker script: end of .noinit and top of RAM,
+// where the stack starts
+extern uint8_t _end;
+extern uint8_t __stack;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+void stack_mark_init(void)
+{
+  uint8_t here;
+  uint8_t* p;
+
+  for(p = &_end; p < &here - STACK_MARK_MARGIN; p++)
+    *p = PATTERN;
+}
+
+uint16_t stack_mark_used(void)
+{
+  const uint8_t* p = &_end;
+  // the stack grows down, the lowest overwritten byte is its deepest point
+  while(p < &__stack && *p == PATTERN)
+    p++;
+  return &__stack - p;
+}
+
+uint16_t stack_mark_size(void)
+{
+  return &__stack - &_end;
+}
@@ -0,0 +1,29 @@
+#ifndef STACK_MARK_H_
+#define STACK_MARK_H_
+
+#include "contiki.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// set to 0 to skip painting the free RAM at boot
+#ifndef STACK_MARK_ENABLED
+#define STACK_MARK_ENABLED 1
+#endif
+// bytes below the caller's frame left unpainted, room for interrupts
+// arriving while the rest is painted
+#ifndef STACK_MARK_MARGIN
+#define STACK_MARK_MARGIN 128
+#endif
+
+/* FUNCTIONS */
+// fills the RAM between the end of .noinit and the current stack with a
+// pattern; call once, as early and as shallow in the stack as possible
+void stack_mark_init(void);
+// deepest the stack has reached since stack_mark_init(), in bytes
+uint16_t stack_mark_used(void);
+// bytes between the end of .noinit and the top of RAM
+uint16_t stack_mark_size(void);
+
+#endif /* STACK_MARK_H_ */
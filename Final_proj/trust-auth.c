@@ -0,0 +1,133 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "net/llsec/anti-replay.h"
+#include "lib/ccm-star.h"
+#include "trust-auth.h"
+
+#include <string.h>
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// security level carried in the last nonce byte (MIC-32/64/128)
+#define SECURITY_LEVEL (TRUST_AUTH_MIC_LEN == 4 ? 1 : TRUST_AUTH_MIC_LEN == 8 ? 2 : 3)
+
+#if TRUST_AUTH_ENABLED
+/* UTILITY FUNCTIONS */
+// builds the CCM* nonce from the sender address and the frame counter
+static void set_nonce(uint8_t* nonce, const linkaddr_t* sender,
+  const uint8_t* counter);
+// computes the MIC over the first len bytes of packetbuf
+static void compute_mic(uint8_t* mic, const linkaddr_t* sender, uint8_t len);
+
+/* GLOBAL VARIABLES */
+static const uint8_t key[16] = TRUST_AUTH_KEY;
+#endif
+// frame counter of the last sealed frame, kept here rather than in
+// anti-replay so that it can be resumed after a reboot
+static uint32_t frame_counter;
+// counter value persisted by the last trust_auth_reserve()
+static uint32_t ceiling;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+int trust_auth_seal(void)
+{
+#if TRUST_AUTH_ENABLED
+  uint8_t* data = packetbuf_dataptr();
+  uint16_t len = packetbuf_datalen();
+  uint32_t counter;
+
+  if(len > TRUST_AUTH_MAX_DATA)
+    return 0;
+
+  counter = trust_auth_next_counter();
+  data[len++] = counter >> 24;
+  data[len++] = counter >> 16;
+  data[len++] = counter >> 8;
+  data[len++] = counter;
+  compute_mic(data + len, &linkaddr_node_addr, len);
+  packetbuf_set_datalen(len + TRUST_AUTH_MIC_LEN);
+#endif
+  return 1;
+}
+
+int trust_auth_verify(const linkaddr_t* from)
+{
+#if TRUST_AUTH_ENABLED
+  uint8_t* data = packetbuf_dataptr();
+  uint16_t len = packetbuf_datalen();
+  uint8_t* counter;
+  uint8_t mic[TRUST_AUTH_MIC_LEN];
+
+  if(len < TRUST_AUTH_COUNTER_LEN + TRUST_AUTH_MIC_LEN)
+    return 0;
+  len -= TRUST_AUTH_MIC_LEN;
+  compute_mic(mic, from, len);
+  if(memcmp(mic, data + len, TRUST_AUTH_MIC_LEN) != 0)
+    return 0;
+
+  // hand the counter to anti-replay through the frame counter attributes,
+  // the same place llsec drivers keep it
+  len -= TRUST_AUTH_COUNTER_LEN;
+  counter = data + len;
+  packetbuf_set_attr(PACKETBUF_ATTR_FRAME_COUNTER_BYTES_2_3,
+    (counter[0] << 8) | counter[1]);
+  packetbuf_set_attr(PACKETBUF_ATTR_FRAME_COUNTER_BYTES_0_1,
+    (counter[2] << 8) | counter[3]);
+  packetbuf_set_datalen(len);
+#endif
+  return 1;
+}
+
+uint32_t trust_auth_next_counter(void)
+{
+  return ++frame_counter;
+}
+
+void trust_auth_resume(uint32_t resumed)
+{
+  if(resumed > frame_counter)
+    frame_counter = resumed;
+  ceiling = frame_counter;
+}
+
+uint32_t trust_auth_reserve(void)
+{
+  if(frame_counter + TRUST_AUTH_COUNTER_JUMP / 2 >= ceiling)
+    ceiling = frame_counter + TRUST_AUTH_COUNTER_JUMP;
+  return ceiling;
+}
+
+int trust_auth_replayed(struct anti_replay_info* info)
+{
+#if TRUST_AUTH_ENABLED
+  return anti_replay_was_replayed(info);
+#else
+  return 0;
+#endif
+}
+
+#if TRUST_AUTH_ENABLED
+static void set_nonce(uint8_t* nonce, const linkaddr_t* sender,
+  const uint8_t* counter)
+{
+  memset(nonce, 0, CCM_STAR_NONCE_LENGTH);
+  memcpy(nonce, sender, LINKADDR_SIZE);
+  memcpy(nonce + 8, counter, TRUST_AUTH_COUNTER_LEN);
+  nonce[12] = SECURITY_LEVEL;
+}
+
+static void compute_mic(uint8_t* mic, const linkaddr_t* sender, uint8_t len)
+{
+  uint8_t nonce[CCM_STAR_NONCE_LENGTH];
+  uint8_t* data = packetbuf_dataptr();
+
+  set_nonce(nonce, sender, data + len - TRUST_AUTH_COUNTER_LEN);
+  // authentication only: the vector is passed as associated data, so CCM*
+  // runs just the CBC-MAC (one AES block per 16 bytes) and no CTR pass
+  CCM_STAR.set_key(key);
+  CCM_STAR.aead(nonce, NULL, 0, data, len, mic, TRUST_AUTH_MIC_LEN, 1);
+}
+#endif
@@ -0,0 +1,61 @@
+#ifndef TRUST_AUTH_H_
+#define TRUST_AUTH_H_
+
+#include "net/rime/rime.h"
+#include "net/llsec/anti-replay.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// set to 0 to send trust vectors without counter and MIC
+#ifndef TRUST_AUTH_ENABLED
+#define TRUST_AUTH_ENABLED 1
+#endif
+// bytes of the truncated CCM* MIC appended to every trust vector
+#ifndef TRUST_AUTH_MIC_LEN
+#define TRUST_AUTH_MIC_LEN 4
+#endif
+// network key shared by all trust nodes
+#ifndef TRUST_AUTH_KEY
+#define TRUST_AUTH_KEY { 0x54, 0x72, 0x75, 0x73, 0x74, 0x47, 0x6f, 0x73, \
+                         0x73, 0x69, 0x70, 0x4b, 0x65, 0x79, 0x30, 0x31 }
+#endif
+// frame counter bytes between the records and the MIC
+#define TRUST_AUTH_COUNTER_LEN 4
+// frames by which the persisted counter ceiling runs ahead of the counter,
+// see trust_auth_reserve()
+#ifndef TRUST_AUTH_COUNTER_JUMP
+#define TRUST_AUTH_COUNTER_JUMP 1024
+#endif
+// largest sealed broadcast: the 127-byte 802.15.4 frame less 11 bytes of
+// MAC header and FCS and the 4-byte Rime broadcast header
+#ifndef TRUST_AUTH_MAX_FRAME
+#define TRUST_AUTH_MAX_FRAME 112
+#endif
+// data that can be sealed, what is left next to the counter and MIC
+#define TRUST_AUTH_MAX_DATA (TRUST_AUTH_MAX_FRAME - TRUST_AUTH_COUNTER_LEN \
+  - TRUST_AUTH_MIC_LEN)
+
+/* FUNCTIONS */
+// appends the frame counter and MIC to the trust vector in packetbuf
+// returns 0 if packetbuf has no room left for them
+int trust_auth_seal(void);
+// checks the MIC of a received trust vector and strips counter and MIC
+// returns 0 if the vector was not sealed with the network key
+int trust_auth_verify(const linkaddr_t* from);
+// returns the next value of the node's frame counter; link-sec frames take
+// theirs from it as well, so one persisted ceiling covers both
+uint32_t trust_auth_next_counter(void);
+// continues the frame counter from a ceiling persisted before a reboot, so
+// neighbors do not drop the node's frames as replays
+void trust_auth_resume(uint32_t ceiling);
+// returns the counter ceiling to persist: no frame has used a counter at or
+// above it; it moves TRUST_AUTH_COUNTER_JUMP ahead once half of it is used,
+// so it only changes every few hundred frames
+uint32_t trust_auth_reserve(void);
+// returns 1 if the last verified vector is not newer than the previous one
+// from the same neighbor, and records its counter otherwise
+int trust_auth_replayed(struct anti_replay_info* info);
+
+#endif /* TRUST_AUTH_H_ */
@@ -0,0 +1,152 @@
+#include "contiki.h"
+#include "net/rime/rime.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+#include "trust-store.h"
+
+#include <string.h>
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// changes with the record layout, older snapshots are then ignored
+#define SNAPSHOT_MAGIC 0x55
+
+/* STRUCTS */
+// what the file starts with
+struct snapshot_header
+{
+  uint8_t magic;
+  uint8_t count;
+  // over the records, catches snapshots torn by a reset
+  uint16_t checksum;
+  // trust-auth frame counter ceiling
+  uint32_t counter;
+};
+
+/* UTILITY FUNCTIONS */
+// Fletcher-16 over the records
+static uint16_t checksum(const struct trust_record* records, int count);
+// returns 1 if records differ enough from the last snapshot to be written
+static int changed(const struct trust_record* records, int count,
+  uint32_t counter);
+
+/* GLOBAL VARIABLES */
+// last snapshot read or written, compared against to skip needless writes
+static struct trust_record saved[TRUST_STORE_MAX_RECORDS];
+static uint8_t saved_count;
+static uint32_t saved_counter;
+// set once the file has been reserved at its full size
+static uint8_t reserved;
+/*---------------------------------------------------------------------------*/
+/*------------------------- DEFINITIONS -------------------------*/
+
+int trust_store_load(struct trust_record* records, int max,
+  uint32_t* counter)
+{
+  struct snapshot_header h;
+  int fd = cfs_open(TRUST_STORE_FILE, CFS_READ);
+  int len;
+
+  *counter = 0;
+  if(fd < 0)
+    return 0;
+  // an existing file was reserved when it was created
+  reserved = 1;
+  if(cfs_read(fd, &h, sizeof(h)) != sizeof(h) || h.magic != SNAPSHOT_MAGIC
+     || h.count > TRUST_STORE_MAX_RECORDS || h.count > max)
+  {
+    cfs_close(fd);
+    return 0;
+  }
+  len = h.count * sizeof(records[0]);
+  if(cfs_read(fd, records, len) != len
+     || checksum(records, h.count) != h.checksum)
+  {
+    cfs_close(fd);
+    return 0;
+  }
+  cfs_close(fd);
+  memcpy(saved, records, len);
+  saved_count = h.count;
+  saved_counter = h.counter;
+  *counter = h.counter;
+  return h.count;
+}
+
+int trust_store_save(const struct trust_record* records, int count,
+  uint32_t counter)
+{
+  struct snapshot_header h;
+  int fd;
+  int len;
+
+  if(count > TRUST_STORE_MAX_RECORDS)
+    count = TRUST_STORE_MAX_RECORDS;
+  if(!changed(records, count, counter))
+    return 0;
+  // a file of fixed size is rewritten in place through Coffee's micro log
+  // instead of being moved to fresh sectors as it grows
+  if(!reserved)
+  {
+    cfs_coffee_reserve(TRUST_STORE_FILE,
+      sizeof(h) + TRUST_STORE_MAX_RECORDS * sizeof(records[0]));
+    reserved = 1;
+  }
+  fd = cfs_open(TRUST_STORE_FILE, CFS_WRITE);
+  if(fd < 0)
+    return 0;
+  h.magic = SNAPSHOT_MAGIC;
+  h.count = count;
+  h.checksum = checksum(records, count);
+  h.counter = counter;
+  len = count * sizeof(records[0]);
+  if(cfs_write(fd, &h, sizeof(h)) != sizeof(h)
+     || cfs_write(fd, records, len) != len)
+  {
+    cfs_close(fd);
+    return 0;
+  }
+  cfs_close(fd);
+  memcpy(saved, records, len);
+  saved_count = count;
+  saved_counter = counter;
+  return 1;
+}
+
+static uint16_t checksum(const struct trust_record* records, int count)
+{
+  const uint8_t* p = (const uint8_t*)records;
+  const uint8_t* end = p + count * sizeof(records[0]);
+  uint16_t a = 0, b = 0;
+
+  for(; p < end; p++)
+  {
+    a = (a + *p) % 255;
+    b = (b + a) % 255;
+  }
+  return (b << 8) | a;
+}
+
+static int changed(const struct trust_record* records, int count,
+  uint32_t counter)
+{
+  int i, j;
+  int d;
+
+  if(count != saved_count || counter != saved_counter)
+    return 1;
+  for(i = 0; i < count; i++)
+  {
+    for(j = 0; j < saved_count; j++)
+      if(linkaddr_cmp(&records[i].addr, &saved[j].addr))
+        break;
+    if(j == saved_count || records[i].isolated != saved[j].isolated)
+      return 1;
+    d = records[i].trust - saved[j].trust;
+    if(d >= TRUST_STORE_MIN_CHANGE || d <= -TRUST_STORE_MIN_CHANGE)
+      return 1;
+  }
+  return 0;
+}
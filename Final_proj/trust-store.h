@@ -0,0 +1,52 @@
+#ifndef TRUST_STORE_H_
+#define TRUST_STORE_H_
+
+#include "contiki.h"
+#include "net/rime/rime.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// set to 0 to keep the trust table in RAM only
+#ifndef TRUST_STORE_ENABLED
+#define TRUST_STORE_ENABLED 1
+#endif
+// Coffee file holding the snapshot
+#ifndef TRUST_STORE_FILE
+#define TRUST_STORE_FILE "trust"
+#endif
+// records a snapshot holds, later neighbors are not persisted
+#ifndef TRUST_STORE_MAX_RECORDS
+#define TRUST_STORE_MAX_RECORDS 16
+#endif
+// trust difference below which a neighbor does not count as changed, so
+// the slow drift of the trust averages does not wear out the flash
+#ifndef TRUST_STORE_MIN_CHANGE
+#define TRUST_STORE_MIN_CHANGE 5
+#endif
+
+/* STRUCTS */
+// one persisted neighbor
+struct trust_record
+{
+  linkaddr_t addr;
+  uint8_t trust;
+  // set if the neighbor was isolated, so it is blocked again on restore
+  uint8_t isolated;
+};
+
+/* FUNCTIONS */
+// reads the last snapshot, returns the number of records or 0 if there is
+// none or it is damaged; counter is set to the saved trust-auth counter
+// ceiling, or 0
+int trust_store_load(struct trust_record* records, int max,
+  uint32_t* counter);
+// writes a snapshot, unless the counter ceiling is unchanged and no
+// neighbor appeared, left, changed isolation or moved by
+// TRUST_STORE_MIN_CHANGE since the last one
+// returns 1 if the flash was written
+int trust_store_save(const struct trust_record* records, int count,
+  uint32_t counter);
+
+#endif /* TRUST_STORE_H_ */
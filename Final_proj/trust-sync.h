@@ -0,0 +1,52 @@
+#ifndef TRUST_SYNC_H_
+#define TRUST_SYNC_H_
+
+#include "contiki.h"
+#include "net/rime/rime.h"
+
+/*------------------------- DECLARATIONS -------------------------*/
+
+/* MACROS */
+
+// anti-entropy trust exchange: instead of its table, every node
+// broadcasts a digest each period, and neighbors whose copy is behind pull
+// the entries that changed since; each change is merged once, where
+// vectors are merged every period, so trust moves more slowly than with
+// vectors and a neighbor takes longer to get isolated
+#ifndef TRUST_SYNC_ENABLED
+#define TRUST_SYNC_ENABLED 0
+#endif
+// gap between the requests and responses a node has queued
+#ifndef TRUST_SYNC_SPACING
+#define TRUST_SYNC_SPACING (CLOCK_SECOND / 16)
+#endif
+
+/* ENUMS */
+// what a sync header on the trust channel announces
+enum trust_sync_type
+{
+  // clock is the sender's table clock, nothing follows
+  TRUST_SYNC_DIGEST,
+  // asks target for the entries changed after since
+  TRUST_SYNC_REQUEST,
+  // trust records changed after since, up to and including clock
+  TRUST_SYNC_ENTRIES
+};
+
+/* STRUCTS */
+// header in front of every trust broadcast in sync mode
+// each entry of a table carries the value of the table clock when its
+// trust last changed, so "changed after since" is a single comparison
+struct trust_sync_header
+{
+  // one of enum trust_sync_type
+  uint8_t type;
+  // requested node, unused otherwise
+  linkaddr_t target;
+  // clock of the requester's copy, 0 for the whole table
+  uint16_t since;
+  // table clock of the sender, or the newest entry of a response
+  uint16_t clock;
+};
+
+#endif /* TRUST_SYNC_H_ */